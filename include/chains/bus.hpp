@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <type_traits>
+
+namespace chains {
+
+// A view of one channel of a bus, with the channel's samples stride elements apart
+template <class T>
+class BusChannel
+{
+  T* data_;
+  int stride_;
+
+public:
+  BusChannel(T* data, int stride) : data_(data), stride_(stride) {}
+
+  T& operator[](int frame) const { return data_[frame * stride_]; }
+
+  T* data() const { return data_; }
+  int stride() const { return stride_; }
+};
+
+// A non-owning view of a block of multi-channel audio in a caller's buffers.
+//
+// Planar buses have a separate contiguous buffer for each channel, and interleaved
+// buses have a single buffer with the channels' samples alternating frame by frame.
+// Both layouts are viewed the same way, with each channel's samples a fixed stride
+// apart, so processors can work on either layout without copying. Processors that
+// need contiguous channels check isPlanar and use channelPointers, processing
+// interleaved buses through their channels' strided views instead.
+template <class T, int Channels>
+class Bus
+{
+  std::array<T*, Channels> channels_;
+  int numFrames_;
+  int frameStride_;
+
+  Bus(const std::array<T*, Channels>& channels, int numFrames, int frameStride)
+    : channels_(channels), numFrames_(numFrames), frameStride_(frameStride)
+  {
+  }
+
+  template <class, int>
+  friend class Bus;
+
+public:
+  static constexpr int numChannels = Channels;
+
+  static Bus planar(const std::array<T*, Channels>& channels, int numFrames)
+  {
+    return Bus{channels, numFrames, 1};
+  }
+
+  static Bus interleaved(T* data, int numFrames)
+  {
+    std::array<T*, Channels> channels;
+    for (auto channel = 0; channel < Channels; ++channel) {
+      channels[channel] = data + channel;
+    }
+    return Bus{channels, numFrames, Channels};
+  }
+
+  // Buses are viewable as buses of const samples
+  template <class U, class = std::enable_if_t<std::is_same<const U, T>::value>>
+  Bus(const Bus<U, Channels>& other)
+    : numFrames_(other.numFrames_), frameStride_(other.frameStride_)
+  {
+    for (auto channel = 0; channel < Channels; ++channel) {
+      channels_[channel] = other.channels_[channel];
+    }
+  }
+
+  int numFrames() const { return numFrames_; }
+
+  bool isPlanar() const { return frameStride_ == 1; }
+
+  BusChannel<T> operator[](int channel) const
+  {
+    return {channels_[channel], frameStride_};
+  }
+
+  T& operator()(int channel, int frame) const
+  {
+    return channels_[channel][frame * frameStride_];
+  }
+
+  // The channels' buffers, only contiguous for planar buses
+  const std::array<T*, Channels>& channelPointers() const
+  {
+    assert(isPlanar());
+    return channels_;
+  }
+
+  // A view of numFrames frames, starting at start
+  Bus subBlock(int start, int numFrames) const
+  {
+    auto channels = channels_;
+    for (auto& channel : channels) {
+      channel += start * frameStride_;
+    }
+    return Bus{channels, numFrames, frameStride_};
+  }
+};
+
+} // chains
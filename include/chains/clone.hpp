@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace chains {
+
+// Copies a prototype processor into uninitialized storage for count processors.
+//
+// Copying a processor copies its state as-is, including derived state like filter
+// coefficients, so the module and init steps aren't repeated for each instance.
+// Callbacks are rebound to each copy by ProcessorHost.
+template <class Processor>
+Processor* cloneInto(const Processor& prototype, Processor* storage, std::size_t count)
+{
+  return std::uninitialized_fill_n(storage, count, prototype);
+}
+
+// Makes count copies of a prototype processor
+template <class Processor>
+auto makeClones(const Processor& prototype, std::size_t count)
+{
+  return std::vector<Processor>(count, prototype);
+}
+
+} // chains
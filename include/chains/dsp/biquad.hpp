@@ -0,0 +1,342 @@
+#pragma once
+
+#include "chains/dsp/fastmath.hpp"
+#include "chains/dsp/fixed_point.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace dsp {
+
+enum class BiquadType
+{
+  LowPass,
+  BandPass,
+  HighPass,
+  AllPass
+};
+
+// Normalized coefficients, with a0 == 1
+struct BiquadCoefficients
+{
+  double b0, b1, b2, a1, a2;
+};
+
+// Coefficients from the RBJ audio EQ cookbook
+template <class Math = fastmath::Default>
+BiquadCoefficients biquadCoefficients(const BiquadType type,
+                                      const double frequency,
+                                      const double q,
+                                      const double sampleRate)
+{
+  const auto w0 = 2.0 * M_PI * frequency / sampleRate;
+  const auto cosW0 = Math::cos(w0);
+  const auto alpha = Math::sin(w0) / (2.0 * q);
+
+  double b0, b1, b2;
+
+  switch (type) {
+  default: assert(false); // Unknown types fall back to low-pass
+  case BiquadType::LowPass:
+    b0 = (1.0 - cosW0) / 2.0;
+    b1 = 1.0 - cosW0;
+    b2 = b0;
+    break;
+  case BiquadType::BandPass:
+    b0 = alpha;
+    b1 = 0.0;
+    b2 = -alpha;
+    break;
+  case BiquadType::HighPass:
+    b0 = (1.0 + cosW0) / 2.0;
+    b1 = -(1.0 + cosW0);
+    b2 = b0;
+    break;
+  case BiquadType::AllPass:
+    b0 = 1.0 - alpha;
+    b1 = -2.0 * cosW0;
+    b2 = 1.0 + alpha;
+    break;
+  }
+
+  const auto a0 = 1.0 + alpha;
+  return {b0 / a0, b1 / a0, b2 / a0, -2.0 * cosW0 / a0, (1.0 - alpha) / a0};
+}
+
+// Estimates the number of frames it takes for a biquad's impulse response to decay by
+// 100dB, based on the magnitude of its largest pole
+inline int biquadTailLength(const double a1, const double a2)
+{
+  const auto discriminant = a1 * a1 - 4.0 * a2;
+  const auto radius =
+    discriminant < 0.0
+      ? std::sqrt(a2)
+      : (std::abs(a1) + std::sqrt(discriminant)) / 2.0;
+
+  if (radius >= 1.0) {
+    return std::numeric_limits<int>::max();
+  }
+
+  // Two extra frames for the feed-forward part of the filter
+  const auto decay = radius > 0.0 ? std::log(1e-5) / std::log(radius) : 0.0;
+  return int(std::min(std::ceil(decay), double(std::numeric_limits<int>::max() - 2))) + 2;
+}
+
+// A direct form 1 biquad filter
+template <class T, class Math = fastmath::Default>
+struct Biquad
+{
+  using Type = BiquadType;
+
+  Biquad(double sampleRate) : sampleRate_(sampleRate) {}
+
+  void setFilter(const Type type, const double frequency, const double q)
+  {
+    type_ = type;
+    frequency_ = frequency;
+    q_ = q;
+
+    const auto c = biquadCoefficients<Math>(type, frequency, q, sampleRate_);
+    b0_ = T(c.b0);
+    b1_ = T(c.b1);
+    b2_ = T(c.b2);
+    a1_ = T(c.a1);
+    a2_ = T(c.a2);
+  }
+
+  void setSampleRate(const double sampleRate)
+  {
+    sampleRate_ = sampleRate;
+    if (q_ > 0.0) {
+      setFilter(type_, frequency_, q_);
+    }
+  }
+
+  void reset() { x1_ = x2_ = y1_ = y2_ = T(0); }
+
+  // Passes the filter's state to a visitor, see chains/state.hpp. The coefficients
+  // are derived from the filter's settings, so they aren't part of the state.
+  template <class Visitor>
+  void visitState(Visitor& visit)
+  {
+    visit(&x1_, 1);
+    visit(&x2_, 1);
+    visit(&y1_, 1);
+    visit(&y2_, 1);
+  }
+
+  int tailLength() const { return biquadTailLength(double(a1_), double(a2_)); }
+
+  auto tick(const T in)
+  {
+    const auto out = b0_ * in + b1_ * x1_ + b2_ * x2_ - a1_ * y1_ - a2_ * y2_;
+
+    x2_ = x1_;
+    x1_ = in;
+    y2_ = y1_;
+    y1_ = out;
+
+    return out;
+  }
+
+  // Processes a block of samples, in and out may point to the same buffer.
+  // The coefficients and state are held in locals for the duration of the block, so
+  // that they aren't reloaded after each write to the output.
+  void process(const T* in, T* out, const int numFrames)
+  {
+    const auto b0 = b0_;
+    const auto b1 = b1_;
+    const auto b2 = b2_;
+    const auto a1 = a1_;
+    const auto a2 = a2_;
+    auto x1 = x1_;
+    auto x2 = x2_;
+    auto y1 = y1_;
+    auto y2 = y2_;
+
+    for (auto i = 0; i < numFrames; ++i) {
+      const auto x = in[i];
+      const auto y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+      x2 = x1;
+      x1 = x;
+      y2 = y1;
+      y1 = y;
+      out[i] = y;
+    }
+
+    x1_ = x1;
+    x2_ = x2;
+    y1_ = y1;
+    y2_ = y2;
+  }
+
+private:
+  T b0_ = T(1);
+  T b1_ = T(0);
+  T b2_ = T(0);
+  T a1_ = T(0);
+  T a2_ = T(0);
+
+  T x1_ = T(0);
+  T x2_ = T(0);
+  T y1_ = T(0);
+  T y2_ = T(0);
+
+  Type type_ = Type::LowPass;
+  double frequency_ = 0.0;
+  double q_ = 0.0;
+  double sampleRate_;
+};
+
+// Fixed-point biquads hold their coefficients with 28 fractional bits, so that
+// coefficients of up to +-8 can be represented, and sum their products in 64 bits. The
+// sum has room for the coefficients of the cookbook filters, whose magnitudes add up
+// to less than 8.
+//
+// The feedback state is held with 31 fractional bits whatever the sample type, so that
+// rounding errors in low resolution types aren't amplified by filters with poles
+// close to the unit circle, and only the output is rounded to the sample type.
+template <class Storage, class Wide, int FractionalBits, class Math>
+struct Biquad<Fixed<Storage, Wide, FractionalBits>, Math>
+{
+  using T = Fixed<Storage, Wide, FractionalBits>;
+  using Type = BiquadType;
+
+  static constexpr int coefficientBits = 28;
+  static constexpr int stateBits = 31;
+  static_assert(FractionalBits <= stateBits, "Samples have up to 31 fractional bits");
+
+  Biquad(double sampleRate) : sampleRate_(sampleRate) {}
+
+  void setFilter(const Type type, const double frequency, const double q)
+  {
+    type_ = type;
+    frequency_ = frequency;
+    q_ = q;
+
+    const auto c = biquadCoefficients<Math>(type, frequency, q, sampleRate_);
+    // The feedforward coefficients also scale the input up to the state's resolution
+    const auto inputScale = double(std::int64_t(1) << (stateBits - FractionalBits));
+    coefficients_ = {coefficient(c.b0 * inputScale), coefficient(c.b1 * inputScale),
+                     coefficient(c.b2 * inputScale), coefficient(c.a1),
+                     coefficient(c.a2)};
+  }
+
+  void setSampleRate(const double sampleRate)
+  {
+    sampleRate_ = sampleRate;
+    if (q_ > 0.0) {
+      setFilter(type_, frequency_, q_);
+    }
+  }
+
+  void reset()
+  {
+    x1_ = x2_ = T(0);
+    y1_ = y2_ = 0;
+  }
+
+  template <class Visitor>
+  void visitState(Visitor& visit)
+  {
+    visit(&x1_, 1);
+    visit(&x2_, 1);
+    visit(&y1_, 1);
+    visit(&y2_, 1);
+  }
+
+  int tailLength() const
+  {
+    const auto scale = double(std::int64_t(1) << coefficientBits);
+    return biquadTailLength(coefficients_.a1 / scale, coefficients_.a2 / scale);
+  }
+
+  auto tick(const T in)
+  {
+    const auto y = next(coefficients_, in, x1_, x2_, y1_, y2_);
+
+    x2_ = x1_;
+    x1_ = in;
+    y2_ = y1_;
+    y1_ = y;
+
+    return output(y);
+  }
+
+  void process(const T* in, T* out, const int numFrames)
+  {
+    const auto coefficients = coefficients_;
+    auto x1 = x1_;
+    auto x2 = x2_;
+    auto y1 = y1_;
+    auto y2 = y2_;
+
+    for (auto i = 0; i < numFrames; ++i) {
+      const auto x = in[i];
+      const auto y = next(coefficients, x, x1, x2, y1, y2);
+      x2 = x1;
+      x1 = x;
+      y2 = y1;
+      y1 = y;
+      out[i] = output(y);
+    }
+
+    x1_ = x1;
+    x2_ = x2;
+    y1_ = y1;
+    y2_ = y2;
+  }
+
+private:
+  // Held in 64 bit integers so that the products don't overflow
+  struct Coefficients
+  {
+    std::int64_t b0, b1, b2, a1, a2;
+  };
+
+  static std::int64_t coefficient(const double value)
+  {
+    return std::int64_t(std::round(value * double(std::int64_t(1) << coefficientBits)));
+  }
+
+  // The next feedback state, saturated to 32 bits
+  static std::int64_t next(const Coefficients& c,
+                           const T x,
+                           const T x1,
+                           const T x2,
+                           const std::int64_t y1,
+                           const std::int64_t y2)
+  {
+    const auto sum =
+      c.b0 * x.raw() + c.b1 * x1.raw() + c.b2 * x2.raw() - c.a1 * y1 - c.a2 * y2;
+    const auto y = (sum + (std::int64_t(1) << (coefficientBits - 1))) >> coefficientBits;
+    const auto limit = std::int64_t(1) << stateBits;
+    return y >= limit ? limit - 1 : y < -limit ? -limit : y;
+  }
+
+  static T output(const std::int64_t y)
+  {
+    const auto shift = stateBits - FractionalBits;
+    const auto rounding = shift > 0 ? std::int64_t(1) << (shift - 1) : std::int64_t(0);
+    return T::saturate(Wide((y + rounding) >> shift));
+  }
+
+  Coefficients coefficients_ = {std::int64_t(1) << (coefficientBits + stateBits
+                                                    - FractionalBits),
+                                0, 0, 0, 0};
+
+  T x1_ = T(0);
+  T x2_ = T(0);
+  std::int64_t y1_ = 0;
+  std::int64_t y2_ = 0;
+
+  Type type_ = Type::LowPass;
+  double frequency_ = 0.0;
+  double q_ = 0.0;
+  double sampleRate_;
+};
+
+} // dsp
@@ -0,0 +1,273 @@
+#pragma once
+
+#include "chains/dsp/fft.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace dsp {
+
+// An impulse response split into equally sized partitions, and transformed for
+// convolution in the frequency domain. It's read-only once constructed, so it can be
+// shared between convolvers.
+//
+// With zeroLatency, the first partition is kept as a head section, and the remaining
+// partitions then line up with the convolver's output without any delay. Short heads
+// are convolved directly, and longer heads are partitioned again into partitions of
+// maxDirectHeadSize, with their own direct head, so that the cost per sample of the
+// head stays small.
+template <class T>
+struct PartitionedImpulseResponse
+{
+  static constexpr int maxDirectHeadSize = 32;
+
+  PartitionedImpulseResponse(const std::vector<double>& samples,
+                             const int partitionSize,
+                             const bool zeroLatency)
+    : partitionSize(partitionSize)
+    , numBins(partitionSize + 1)
+    , length(int(samples.size()))
+    , zeroLatency(zeroLatency)
+    , fft(sharedFft<T>(partitionSize * 2))
+  {
+    const auto begin = zeroLatency ? std::min(partitionSize, length) : 0;
+
+    if (zeroLatency && partitionSize <= maxDirectHeadSize) {
+      head.assign(partitionSize, T(0));
+      std::copy(samples.begin(), samples.begin() + begin, head.begin());
+    } else if (zeroLatency) {
+      headResponse = std::make_shared<const PartitionedImpulseResponse>(
+        std::vector<double>(samples.begin(), samples.begin() + begin), maxDirectHeadSize,
+        true);
+    }
+
+    numPartitions = (length - begin + partitionSize - 1) / partitionSize;
+    re.resize(numPartitions * numBins);
+    im.resize(numPartitions * numBins);
+
+    std::vector<T> partition(partitionSize * 2);
+    for (auto i = 0; i < numPartitions; ++i) {
+      std::fill(partition.begin(), partition.end(), T(0));
+      const auto start = begin + i * partitionSize;
+      const auto end = std::min(start + partitionSize, length);
+      std::copy(samples.begin() + start, samples.begin() + end, partition.begin());
+      fft->forward(partition.data(), &re[i * numBins], &im[i * numBins]);
+    }
+  }
+
+  int partitionSize;
+  int numPartitions;
+  int numBins;
+  int length;
+  bool zeroLatency;
+  // The head's taps when it's convolved directly
+  std::vector<T> head;
+  // The head's partitions when it's longer than maxDirectHeadSize
+  std::shared_ptr<const PartitionedImpulseResponse> headResponse;
+  std::vector<T> re;
+  std::vector<T> im;
+  std::shared_ptr<const Fft<T>> fft;
+};
+
+// A uniformly partitioned overlap-save convolver.
+//
+// Blocks are copied into the current partition of input, and each time a partition
+// has been filled, it's transformed and stored in a frequency domain delay line, which
+// is multiplied with the impulse response's partitions to produce the output for the
+// next partition. Without a zero latency head section, the convolver's latency is one
+// partition. Long head sections are processed in blocks by a nested convolver with
+// shorter partitions.
+template <class T>
+class Convolver
+{
+  std::shared_ptr<const PartitionedImpulseResponse<T>> ir_;
+  int position_ = 0;
+  int historyPosition_ = 0;
+  int delayLinePosition_ = 0;
+  // The previous and current partitions of input
+  std::vector<T> input_;
+  // The input for a direct head section, stored twice so that it can be read
+  // contiguously
+  std::vector<T> history_;
+  std::vector<T> delayLineRe_;
+  std::vector<T> delayLineIm_;
+  std::vector<T> sumRe_;
+  std::vector<T> sumIm_;
+  std::vector<T> result_;
+  std::vector<T> output_;
+  std::vector<T> headOutput_;
+  // The convolver for a partitioned head section, if there is one, held in a vector so
+  // that convolvers can be copied
+  std::vector<Convolver> head_;
+
+public:
+  explicit Convolver(std::shared_ptr<const PartitionedImpulseResponse<T>> ir)
+    : ir_(std::move(ir))
+    , input_(ir_->partitionSize * 2)
+    , history_(ir_->head.size() * 2)
+    , delayLineRe_(ir_->numPartitions * ir_->numBins)
+    , delayLineIm_(ir_->numPartitions * ir_->numBins)
+    , sumRe_(ir_->numBins)
+    , sumIm_(ir_->numBins)
+    , result_(ir_->partitionSize * 2)
+    , output_(ir_->partitionSize)
+  {
+    if (ir_->headResponse) {
+      headOutput_.resize(ir_->partitionSize);
+      head_.emplace_back(ir_->headResponse);
+    }
+  }
+
+  int latency() const { return ir_->zeroLatency ? 0 : ir_->partitionSize; }
+  int tailLength() const { return ir_->length + latency(); }
+
+  // The impulse response is shared, so it isn't included
+  std::size_t heapSize() const
+  {
+    auto size = std::size_t(0);
+    for (const auto* buffer : {&input_, &history_, &delayLineRe_, &delayLineIm_, &sumRe_,
+                               &sumIm_, &result_, &output_, &headOutput_}) {
+      size += buffer->capacity() * sizeof(T);
+    }
+    for (const auto& head : head_) {
+      size += sizeof(head) + head.heapSize();
+    }
+    return size;
+  }
+
+  void reset()
+  {
+    for (auto* buffer : {&input_, &history_, &delayLineRe_, &delayLineIm_, &output_}) {
+      std::fill(buffer->begin(), buffer->end(), T(0));
+    }
+    position_ = 0;
+    historyPosition_ = 0;
+    delayLinePosition_ = 0;
+    for (auto& head : head_) {
+      head.reset();
+    }
+  }
+
+  // Passes the input history, delay line and pending output to a visitor, see
+  // chains/state.hpp. The impulse response isn't part of the state.
+  template <class Visitor>
+  void visitState(Visitor& visit)
+  {
+    visit(&position_, 1);
+    visit(&historyPosition_, 1);
+    visit(&delayLinePosition_, 1);
+    visit(input_.data(), input_.size());
+    visit(history_.data(), history_.size());
+    visit(delayLineRe_.data(), delayLineRe_.size());
+    visit(delayLineIm_.data(), delayLineIm_.size());
+    visit(output_.data(), output_.size());
+    for (auto& head : head_) {
+      head.visitState(visit);
+    }
+  }
+
+  T tick(const T in)
+  {
+    auto out = T(0);
+    process(&in, &out, 1);
+    return out;
+  }
+
+  // in and out may point to the same buffer
+  void process(const T* in, T* out, int numFrames)
+  {
+    const auto partitionSize = ir_->partitionSize;
+
+    while (numFrames > 0) {
+      const auto count = std::min(numFrames, partitionSize - position_);
+
+      // The input is copied first, and then read by the head from the copy
+      auto* block = input_.data() + partitionSize + position_;
+      std::copy_n(in, count, block);
+      std::copy_n(output_.data() + position_, count, out);
+
+      if (!head_.empty()) {
+        head_.front().process(block, headOutput_.data(), count);
+        for (auto i = 0; i < count; ++i) {
+          out[i] += headOutput_[i];
+        }
+      } else if (!ir_->head.empty()) {
+        processDirectHead(block, out, count);
+      }
+
+      in += count;
+      out += count;
+      numFrames -= count;
+      position_ += count;
+
+      if (position_ == partitionSize) {
+        processPartition();
+        position_ = 0;
+      }
+    }
+  }
+
+private:
+  // Adds the convolution of the input with the head's taps to the output
+  void processDirectHead(const T* in, T* out, const int numFrames)
+  {
+    const auto headSize = int(ir_->head.size());
+    const auto* head = ir_->head.data();
+
+    for (auto i = 0; i < numFrames; ++i) {
+      historyPosition_ = (historyPosition_ == 0 ? headSize : historyPosition_) - 1;
+      history_[historyPosition_] = in[i];
+      history_[historyPosition_ + headSize] = in[i];
+
+      const auto* history = history_.data() + historyPosition_;
+      auto sum = T(0);
+      for (auto tap = 0; tap < headSize; ++tap) {
+        sum += head[tap] * history[tap];
+      }
+      out[i] += sum;
+    }
+  }
+
+  void processPartition()
+  {
+    const auto partitionSize = ir_->partitionSize;
+    const auto numPartitions = ir_->numPartitions;
+    const auto numBins = ir_->numBins;
+
+    if (numPartitions > 0) {
+      // The delay line runs backwards, so the newest spectrum is followed by the
+      // older ones in the order of the impulse response's partitions
+      delayLinePosition_ =
+        (delayLinePosition_ == 0 ? numPartitions : delayLinePosition_) - 1;
+      ir_->fft->forward(input_.data(), &delayLineRe_[delayLinePosition_ * numBins],
+                        &delayLineIm_[delayLinePosition_ * numBins]);
+
+      std::fill(sumRe_.begin(), sumRe_.end(), T(0));
+      std::fill(sumIm_.begin(), sumIm_.end(), T(0));
+
+      for (auto partition = 0; partition < numPartitions; ++partition) {
+        const auto slot = (delayLinePosition_ + partition) % numPartitions;
+        const auto* xRe = &delayLineRe_[slot * numBins];
+        const auto* xIm = &delayLineIm_[slot * numBins];
+        const auto* hRe = &ir_->re[partition * numBins];
+        const auto* hIm = &ir_->im[partition * numBins];
+
+        for (auto bin = 0; bin < numBins; ++bin) {
+          sumRe_[bin] += xRe[bin] * hRe[bin] - xIm[bin] * hIm[bin];
+          sumIm_[bin] += xRe[bin] * hIm[bin] + xIm[bin] * hRe[bin];
+        }
+      }
+
+      ir_->fft->inverse(sumRe_.data(), sumIm_.data(), result_.data());
+
+      // The second half of the overlap-save result is valid
+      std::copy(result_.begin() + partitionSize, result_.end(), output_.begin());
+    }
+
+    std::copy(input_.begin() + partitionSize, input_.end(), input_.begin());
+  }
+};
+
+} // dsp
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "chains/dsp/fastmath.hpp"
+
+#include <array>
+#include <cmath>
+
+namespace dsp {
+
+enum class FadeCurve
+{
+  Linear,
+  EqualPower,
+  SCurve,
+  Logarithmic
+};
+
+// A read-only lookup table for a function over [0, 1], with linear interpolation
+template <int Size>
+class InterpolatedTable
+{
+  // An extra point at the end avoids bounds checks when interpolating at 1
+  std::array<double, Size + 2> table_;
+
+public:
+  template <class Function>
+  explicit InterpolatedTable(Function function)
+  {
+    for (auto i = 0; i <= Size; ++i) {
+      table_[i] = function(double(i) / Size);
+    }
+    table_[Size + 1] = table_[Size];
+  }
+
+  // x is clamped to [0, 1]
+  template <class T>
+  T operator()(const T x) const
+  {
+    const auto clamped = !(x > T(0)) ? T(0) : x < T(1) ? x : T(1);
+    const auto position = clamped * T(Size);
+    const auto index = int(position);
+    const auto fraction = position - T(index);
+    const auto a = T(table_[index]);
+    const auto b = T(table_[index + 1]);
+    return a + (b - a) * fraction;
+  }
+};
+
+// The table for logarithmic fades, shared between all crossfades
+inline const auto& logFadeTable()
+{
+  static const InterpolatedTable<256> table{
+    [](double x) { return std::log10(1.0 + 9.0 * x); }};
+  return table;
+}
+
+// The gain applied to a signal that is fading in, for x in [0, 1].
+// The gain for the signal fading out is fadeGain(curve, 1 - x).
+template <FadeCurve Curve, class Math = fastmath::Default, class T>
+T fadeGain(const T x)
+{
+  switch (Curve) {
+  case FadeCurve::Linear: return x;
+  case FadeCurve::EqualPower: return Math::sin(x * T(M_PI / 2.0));
+  case FadeCurve::SCurve: return x * x * (T(3) - T(2) * x);
+  case FadeCurve::Logarithmic: return logFadeTable()(x);
+  }
+  return x;
+}
+
+template <class Math = fastmath::Default, class T>
+T fadeGain(const FadeCurve curve, const T x)
+{
+  switch (curve) {
+  case FadeCurve::Linear: return fadeGain<FadeCurve::Linear, Math>(x);
+  case FadeCurve::EqualPower: return fadeGain<FadeCurve::EqualPower, Math>(x);
+  case FadeCurve::SCurve: return fadeGain<FadeCurve::SCurve, Math>(x);
+  case FadeCurve::Logarithmic: return fadeGain<FadeCurve::Logarithmic, Math>(x);
+  }
+  return x;
+}
+
+} // dsp
@@ -0,0 +1,361 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Approximations of transcendental functions with selectable accuracy.
+//
+// Each accuracy tier provides scalar sin, cos, tan, exp, exp2, log2 and pow functions.
+// The approximations are branch-free polynomials, and the block versions below are
+// plain loops over them, which the compiler can vectorize when optimizing, e.g. with
+// -O3 as the benchmark and render targets are built. The library itself doesn't set
+// any optimization flags.
+//
+// Chains use Exact unless an approximate tier is selected when making a processor.
+//
+// Error bounds, for inputs in the ranges used by the chains' modules:
+// - Exact: the standard library functions
+// - Precise: 1e-6, absolute for sin and cos, relative for the others
+// - Fast: 1e-3, absolute for sin and cos, relative for the others
+//
+// tan's error grows near its poles, and pow's relative error scales with
+// |y * log2(x)|; the bounds above hold for |y * log2(x)| <= 8.
+
+namespace dsp {
+namespace fastmath {
+
+namespace detail {
+
+template <class T>
+struct FloatBits;
+
+template <>
+struct FloatBits<float>
+{
+  using Int = std::int32_t;
+  static constexpr int mantissaBits = 23;
+  static constexpr int exponentBias = 127;
+};
+
+template <>
+struct FloatBits<double>
+{
+  using Int = std::int64_t;
+  static constexpr int mantissaBits = 52;
+  static constexpr int exponentBias = 1023;
+};
+
+// Returns x * 2^n, with n clamped to the range of normal exponents, [1 - bias, bias],
+// so that it can't spill into the sign bit or produce a zero or infinite scale
+template <class T>
+T scaleByPowerOfTwo(const T x, const int n)
+{
+  using Bits = FloatBits<T>;
+  const auto clamped =
+    n < 1 - Bits::exponentBias ? 1 - Bits::exponentBias
+                               : n > Bits::exponentBias ? Bits::exponentBias : n;
+  const auto bits = typename Bits::Int(clamped + Bits::exponentBias)
+                    << Bits::mantissaBits;
+  T scale;
+  std::memcpy(&scale, &bits, sizeof(T));
+  return x * scale;
+}
+
+// Splits x into a mantissa in [sqrt(0.5), sqrt(2)) and an exponent, for positive
+// normal x, see log2Polynomial for other values
+template <class T>
+T splitExponent(const T x, T& exponent)
+{
+  using Bits = FloatBits<T>;
+  using Int = typename Bits::Int;
+
+  Int bits;
+  std::memcpy(&bits, &x, sizeof(T));
+
+  // The mantissa in [1, 2), with the exponent bits replaced by the bias
+  const auto mantissaMask = (Int(1) << Bits::mantissaBits) - 1;
+  const auto mantissaBits =
+    (bits & mantissaMask) | (Int(Bits::exponentBias) << Bits::mantissaBits);
+  const auto e = T((bits >> Bits::mantissaBits) - Bits::exponentBias);
+
+  T mantissa;
+  std::memcpy(&mantissa, &mantissaBits, sizeof(T));
+
+  const auto large = mantissa > T(M_SQRT2);
+  mantissa = large ? mantissa * T(0.5) : mantissa;
+  exponent = large ? e + T(1) : e;
+  return mantissa;
+}
+
+// Rounds to the nearest integer, without the library call that std::nearbyint can
+// compile to. x is clamped to +-2^30 so that the conversion can't overflow.
+template <class T>
+int roundToInt(const T x)
+{
+  const auto limit = T(1 << 30);
+  const auto clamped = !(x > -limit) ? -limit : x < limit ? x : limit;
+  return int(clamped + (clamped < T(0) ? T(-0.5) : T(0.5)));
+}
+
+// Polynomial approximations of sin and cos over [-pi/4, pi/4], the number of terms
+// determines the accuracy
+template <int Terms, class T>
+T sinPolynomial(const T x)
+{
+  const auto x2 = x * x;
+  auto result = T(0);
+  auto coefficient = T(1);
+  T coefficients[Terms];
+  for (auto i = 0; i < Terms; ++i) {
+    coefficients[i] = coefficient;
+    coefficient /= -T((2 * i + 2) * (2 * i + 3));
+  }
+  for (auto i = Terms - 1; i >= 0; --i) {
+    result = result * x2 + coefficients[i];
+  }
+  return result * x;
+}
+
+template <int Terms, class T>
+T cosPolynomial(const T x)
+{
+  const auto x2 = x * x;
+  auto result = T(0);
+  auto coefficient = T(1);
+  T coefficients[Terms];
+  for (auto i = 0; i < Terms; ++i) {
+    coefficients[i] = coefficient;
+    coefficient /= -T((2 * i + 1) * (2 * i + 2));
+  }
+  for (auto i = Terms - 1; i >= 0; --i) {
+    result = result * x2 + coefficients[i];
+  }
+  return result;
+}
+
+// sin(x + quadrantOffset * pi / 2), reduced to [-pi/4, pi/4] by quadrant
+template <int SinTerms, int CosTerms, class T>
+T sinQuadrant(const T x, const int quadrantOffset)
+{
+  const auto quadrant = roundToInt(x * T(2.0 / M_PI));
+  const auto r = x - T(quadrant) * T(M_PI / 2.0);
+  const auto q = (quadrant + quadrantOffset) & 3;
+  const auto s = sinPolynomial<SinTerms>(r);
+  const auto c = cosPolynomial<CosTerms>(r);
+  const auto value = (q & 1) ? c : s;
+  return (q & 2) ? -value : value;
+}
+
+template <int SinTerms, int CosTerms, class T>
+T tanQuadrant(const T x)
+{
+  const auto quadrant = roundToInt(x * T(2.0 / M_PI));
+  const auto r = x - T(quadrant) * T(M_PI / 2.0);
+  const auto s = sinPolynomial<SinTerms>(r);
+  const auto c = cosPolynomial<CosTerms>(r);
+  return (quadrant & 1) ? -c / s : s / c;
+}
+
+// 2^x, as 2^n * 2^f with f in [-0.5, 0.5]. Results below the smallest normal value
+// are flushed to 0, and results above the largest exponent are infinite.
+template <int Terms, class T>
+T exp2Polynomial(const T x)
+{
+  const auto lowest = T(1 - FloatBits<T>::exponentBias);
+  const auto highest = T(FloatBits<T>::exponentBias);
+  const auto clamped = x < lowest ? lowest : x > highest ? highest : x;
+  const auto n = roundToInt(clamped);
+  const auto f = (x - T(n)) * T(M_LN2);
+  auto result = T(0);
+  auto coefficient = T(1);
+  T coefficients[Terms + 1];
+  for (auto i = 0; i <= Terms; ++i) {
+    coefficients[i] = coefficient;
+    coefficient /= T(i + 1);
+  }
+  for (auto i = Terms; i >= 0; --i) {
+    result = result * f + coefficients[i];
+  }
+  const auto scaled = scaleByPowerOfTwo(result, n);
+  return x > highest ? std::numeric_limits<T>::infinity()
+         : x >= lowest ? scaled
+         : x < lowest ? T(0) : x; // NaN
+}
+
+// log2(x), using the atanh series for the mantissa's log. Denormals are scaled into
+// the normal range first, log2(0) is -inf, and negative values give NaN.
+template <int Terms, class T>
+T log2Polynomial(const T x)
+{
+  using Limits = std::numeric_limits<T>;
+  const auto denormal = x < Limits::min();
+  const auto normal = denormal ? x * T(18446744073709551616.0) : x; // 2^64
+
+  T exponent;
+  const auto m = splitExponent(normal, exponent);
+  const auto s = (m - T(1)) / (m + T(1));
+  const auto s2 = s * s;
+  auto result = T(0);
+  for (auto i = Terms - 1; i >= 0; --i) {
+    result = result * s2 + T(1) / T(2 * i + 1);
+  }
+  const auto log = exponent - (denormal ? T(64) : T(0)) + result * s * T(2.0 / M_LN2);
+  return x > T(0) && x < Limits::infinity() ? log
+         : x == T(0) ? -Limits::infinity()
+         : x == Limits::infinity() ? x : Limits::quiet_NaN();
+}
+
+// An approximated accuracy tier, defined by the number of polynomial terms used
+template <int SinTerms, int CosTerms, int ExpTerms, int LogTerms>
+struct Approximate
+{
+  template <class T>
+  static T sin(const T x)
+  {
+    return sinQuadrant<SinTerms, CosTerms>(x, 0);
+  }
+
+  template <class T>
+  static T cos(const T x)
+  {
+    return sinQuadrant<SinTerms, CosTerms>(x, 1);
+  }
+
+  template <class T>
+  static T tan(const T x)
+  {
+    return tanQuadrant<SinTerms, CosTerms>(x);
+  }
+
+  template <class T>
+  static T exp2(const T x)
+  {
+    return exp2Polynomial<ExpTerms>(x);
+  }
+
+  template <class T>
+  static T exp(const T x)
+  {
+    return exp2(x * T(M_LOG2E));
+  }
+
+  template <class T>
+  static T log2(const T x)
+  {
+    return log2Polynomial<LogTerms>(x);
+  }
+
+  // x^y for positive x
+  template <class T>
+  static T pow(const T x, const T y)
+  {
+    return exp2(y * log2(x));
+  }
+};
+
+} // detail
+
+struct Exact
+{
+  template <class T>
+  static T sin(const T x)
+  {
+    return std::sin(x);
+  }
+
+  template <class T>
+  static T cos(const T x)
+  {
+    return std::cos(x);
+  }
+
+  template <class T>
+  static T tan(const T x)
+  {
+    return std::tan(x);
+  }
+
+  template <class T>
+  static T exp(const T x)
+  {
+    return std::exp(x);
+  }
+
+  template <class T>
+  static T exp2(const T x)
+  {
+    return std::exp2(x);
+  }
+
+  template <class T>
+  static T log2(const T x)
+  {
+    return std::log2(x);
+  }
+
+  template <class T>
+  static T pow(const T x, const T y)
+  {
+    return std::pow(x, y);
+  }
+};
+
+struct Precise : detail::Approximate<5, 5, 7, 5>
+{
+};
+
+struct Fast : detail::Approximate<3, 3, 4, 3>
+{
+};
+
+// The accuracy used when a chain's processor is made without specifying one, so that
+// the approximations are only used when they're asked for
+using Default = Exact;
+
+// Block versions of the functions, operating on numFrames values
+
+template <class Accuracy, class T>
+void sin(const T* in, T* out, int numFrames)
+{
+  for (auto i = 0; i < numFrames; ++i) {
+    out[i] = Accuracy::sin(in[i]);
+  }
+}
+
+template <class Accuracy, class T>
+void cos(const T* in, T* out, int numFrames)
+{
+  for (auto i = 0; i < numFrames; ++i) {
+    out[i] = Accuracy::cos(in[i]);
+  }
+}
+
+template <class Accuracy, class T>
+void tan(const T* in, T* out, int numFrames)
+{
+  for (auto i = 0; i < numFrames; ++i) {
+    out[i] = Accuracy::tan(in[i]);
+  }
+}
+
+template <class Accuracy, class T>
+void exp(const T* in, T* out, int numFrames)
+{
+  for (auto i = 0; i < numFrames; ++i) {
+    out[i] = Accuracy::exp(in[i]);
+  }
+}
+
+template <class Accuracy, class T>
+void pow(const T* x, const T* y, T* out, int numFrames)
+{
+  for (auto i = 0; i < numFrames; ++i) {
+    out[i] = Accuracy::pow(x[i], y[i]);
+  }
+}
+
+} // fastmath
+} // dsp
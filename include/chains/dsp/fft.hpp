@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace dsp {
+
+// A real FFT for power of two sizes.
+//
+// Spectra are stored in split format, with separate real and imaginary arrays of
+// size / 2 + 1 bins, which keeps the inner loops of the FFT and of spectral
+// processing simple enough for the compiler to vectorize.
+//
+// The FFT is read-only once constructed, so a single instance can be shared between
+// processors, see sharedFft below.
+template <class T>
+class Fft
+{
+  int size_;
+  int half_;
+  std::vector<int> bitReversed_;
+  // Twiddles for each stage of the half-size complex FFT, stored contiguously
+  std::vector<T> twiddleRe_;
+  std::vector<T> twiddleIm_;
+  // Twiddles used to split the half-size complex spectrum into the real spectrum
+  std::vector<T> splitRe_;
+  std::vector<T> splitIm_;
+
+public:
+  explicit Fft(const int size)
+    : size_(size)
+    , half_(size / 2)
+    , bitReversed_(half_)
+    , splitRe_(half_)
+    , splitIm_(half_)
+  {
+    assert(size >= 4 && (size & (size - 1)) == 0);
+
+    auto bits = 0;
+    while ((1 << bits) < half_) {
+      ++bits;
+    }
+
+    for (auto i = 0; i < half_; ++i) {
+      auto reversed = 0;
+      for (auto bit = 0; bit < bits; ++bit) {
+        reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+      }
+      bitReversed_[i] = reversed;
+    }
+
+    for (auto length = 2; length <= half_; length *= 2) {
+      for (auto i = 0; i < length / 2; ++i) {
+        const auto angle = -2.0 * M_PI * i / length;
+        twiddleRe_.push_back(T(std::cos(angle)));
+        twiddleIm_.push_back(T(std::sin(angle)));
+      }
+    }
+
+    for (auto k = 0; k < half_; ++k) {
+      const auto angle = -2.0 * M_PI * k / size_;
+      splitRe_[k] = T(std::cos(angle));
+      splitIm_[k] = T(std::sin(angle));
+    }
+  }
+
+  int size() const { return size_; }
+  int numBins() const { return half_ + 1; }
+
+  // Transforms size real samples into numBins complex bins
+  void forward(const T* in, T* re, T* im) const
+  {
+    // The even and odd samples are packed into the real and imaginary parts of a
+    // half-size complex sequence
+    for (auto i = 0; i < half_; ++i) {
+      re[bitReversed_[i]] = in[2 * i];
+      im[bitReversed_[i]] = in[2 * i + 1];
+    }
+
+    transform(re, im);
+
+    const auto re0 = re[0];
+    const auto im0 = im[0];
+
+    for (auto k = 1; k <= half_ / 2; ++k) {
+      const auto j = half_ - k;
+
+      const auto evenRe = (re[k] + re[j]) * T(0.5);
+      const auto evenIm = (im[k] - im[j]) * T(0.5);
+      const auto oddRe = (im[k] + im[j]) * T(0.5);
+      const auto oddIm = (re[j] - re[k]) * T(0.5);
+
+      const auto wRe = splitRe_[k];
+      const auto wIm = splitIm_[k];
+      const auto twiddledRe = wRe * oddRe - wIm * oddIm;
+      const auto twiddledIm = wRe * oddIm + wIm * oddRe;
+
+      // Bin j's values follow from the conjugate symmetry of the even and odd parts
+      re[k] = evenRe + twiddledRe;
+      im[k] = evenIm + twiddledIm;
+      re[j] = evenRe - twiddledRe;
+      im[j] = twiddledIm - evenIm;
+    }
+
+    re[0] = re0 + im0;
+    im[0] = T(0);
+    re[half_] = re0 - im0;
+    im[half_] = T(0);
+  }
+
+  // Transforms numBins complex bins into size real samples, undoing forward.
+  // The bins are used as working space, so their contents are lost.
+  void inverse(T* re, T* im, T* out) const
+  {
+    // Each pair of bins k and half_ - k gives the same pair of bins of the half-size
+    // complex sequence z = even + i * odd, which is conjugated for the inverse
+    for (auto k = 0; k <= half_ / 2; ++k) {
+      const auto j = half_ - k;
+
+      const auto reK = re[k];
+      const auto imK = im[k];
+      const auto reJ = re[j];
+      const auto imJ = im[j];
+
+      const auto evenRe = (reK + reJ) * T(0.5);
+      const auto evenIm = (imK - imJ) * T(0.5);
+      const auto diffRe = (reK - reJ) * T(0.5);
+      const auto diffIm = (imK + imJ) * T(0.5);
+
+      // Undo the twiddles with their conjugates, bin j's twiddle is -conj(k's)
+      const auto wRe = splitRe_[k];
+      const auto wIm = -splitIm_[k];
+      const auto oddRe = wRe * diffRe - wIm * diffIm;
+      const auto oddIm = wRe * diffIm + wIm * diffRe;
+
+      re[k] = evenRe - oddIm;
+      im[k] = -(evenIm + oddRe);
+
+      if (j != k && j < half_) {
+        re[j] = evenRe + oddIm;
+        im[j] = evenIm - oddRe;
+      }
+    }
+
+    for (auto i = 0; i < half_; ++i) {
+      const auto reversed = bitReversed_[i];
+      if (i < reversed) {
+        std::swap(re[i], re[reversed]);
+        std::swap(im[i], im[reversed]);
+      }
+    }
+
+    transform(re, im);
+
+    const auto scale = T(1) / T(half_);
+    for (auto i = 0; i < half_; ++i) {
+      out[2 * i] = re[i] * scale;
+      out[2 * i + 1] = -im[i] * scale;
+    }
+  }
+
+private:
+  // An in-place radix-2 complex FFT of half_ points, on bit-reversed input
+  void transform(T* re, T* im) const
+  {
+    auto twiddle = 0;
+    for (auto length = 2; length <= half_; length *= 2) {
+      const auto halfLength = length / 2;
+      const auto* wRe = twiddleRe_.data() + twiddle;
+      const auto* wIm = twiddleIm_.data() + twiddle;
+
+      for (auto start = 0; start < half_; start += length) {
+        auto* aRe = re + start;
+        auto* aIm = im + start;
+        auto* bRe = aRe + halfLength;
+        auto* bIm = aIm + halfLength;
+
+        for (auto i = 0; i < halfLength; ++i) {
+          const auto tRe = bRe[i] * wRe[i] - bIm[i] * wIm[i];
+          const auto tIm = bRe[i] * wIm[i] + bIm[i] * wRe[i];
+          bRe[i] = aRe[i] - tRe;
+          bIm[i] = aIm[i] - tIm;
+          aRe[i] += tRe;
+          aIm[i] += tIm;
+        }
+      }
+
+      twiddle += halfLength;
+    }
+  }
+};
+
+// Returns an FFT of the given size, shared with all other users of the same size.
+// Creating an FFT allocates, so this should be called when preparing processors.
+template <class T>
+std::shared_ptr<const Fft<T>> sharedFft(const int size)
+{
+  static std::mutex mutex;
+  static std::map<int, std::weak_ptr<const Fft<T>>> ffts;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto& cached = ffts[size];
+  if (auto fft = cached.lock()) {
+    return fft;
+  }
+
+  auto fft = std::make_shared<const Fft<T>>(size);
+  cached = fft;
+  return fft;
+}
+
+} // dsp
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace dsp {
+
+// A signed fixed-point sample type, with FractionalBits fractional bits held in
+// Storage, and intermediate results calculated in Wide.
+//
+// Values are in [-1, 1), and arithmetic saturates at the ends of the range rather than
+// wrapping, so overloads clip like analog hardware instead of producing full-scale
+// noise. Conversions from floating point are explicit, so that the per-sample code
+// paths only use integer arithmetic.
+template <class Storage, class Wide, int FractionalBits>
+class Fixed
+{
+  static_assert(sizeof(Wide) >= 2 * sizeof(Storage), "Wide needs room for products");
+
+  template <class Number>
+  using EnableIfFloatingPoint = std::enable_if_t<std::is_floating_point<Number>::value, int>;
+
+public:
+  using StorageType = Storage;
+  using WideType = Wide;
+  static constexpr int fractionalBits = FractionalBits;
+  static constexpr Wide one = Wide(1) << FractionalBits;
+  static constexpr Wide maxRaw = std::numeric_limits<Storage>::max();
+  static constexpr Wide minRaw = std::numeric_limits<Storage>::min();
+
+  constexpr Fixed() = default;
+
+  // Rounds to the nearest value, saturating at the ends of the range
+  template <class Number, EnableIfFloatingPoint<Number> = 0>
+  explicit Fixed(const Number value)
+  {
+    const auto scaled = std::round(double(value) * double(one));
+    value_ = scaled >= double(maxRaw) ? Storage(maxRaw)
+             : scaled <= double(minRaw) ? Storage(minRaw) : Storage(scaled);
+  }
+
+  // Integers other than 0 and -1 saturate
+  template <class Number, std::enable_if_t<std::is_integral<Number>::value, int> = 0>
+  constexpr explicit Fixed(const Number value)
+    : value_(value > 0 ? Storage(maxRaw) : value < 0 ? Storage(minRaw) : Storage(0))
+  {
+  }
+
+  // Makes a value from a raw result with FractionalBits fractional bits, saturating
+  // if it's out of range
+  static constexpr Fixed saturate(const Wide raw)
+  {
+    return fromRaw(Storage(raw > maxRaw ? maxRaw : raw < minRaw ? minRaw : raw));
+  }
+
+  static constexpr Fixed fromRaw(const Storage raw)
+  {
+    auto result = Fixed{};
+    result.value_ = raw;
+    return result;
+  }
+
+  constexpr Storage raw() const { return value_; }
+
+  template <class Number, EnableIfFloatingPoint<Number> = 0>
+  constexpr explicit operator Number() const
+  {
+    return Number(value_) / Number(one);
+  }
+
+  friend constexpr Fixed operator+(const Fixed a, const Fixed b)
+  {
+    return saturate(Wide(a.value_) + Wide(b.value_));
+  }
+
+  friend constexpr Fixed operator-(const Fixed a, const Fixed b)
+  {
+    return saturate(Wide(a.value_) - Wide(b.value_));
+  }
+
+  // Rounds to the nearest value
+  friend constexpr Fixed operator*(const Fixed a, const Fixed b)
+  {
+    return saturate((Wide(a.value_) * Wide(b.value_) + (one >> 1)) >> FractionalBits);
+  }
+
+  // Division by zero saturates towards the sign of the dividend
+  friend constexpr Fixed operator/(const Fixed a, const Fixed b)
+  {
+    return b.value_ == 0 ? saturate(a.value_ >= 0 ? maxRaw : minRaw)
+                         : saturate(Wide(a.value_) * one / Wide(b.value_));
+  }
+
+  constexpr Fixed operator-() const { return saturate(-Wide(value_)); }
+
+  Fixed& operator+=(const Fixed other) { return *this = *this + other; }
+  Fixed& operator-=(const Fixed other) { return *this = *this - other; }
+  Fixed& operator*=(const Fixed other) { return *this = *this * other; }
+  Fixed& operator/=(const Fixed other) { return *this = *this / other; }
+
+  friend constexpr bool operator==(Fixed a, Fixed b) { return a.value_ == b.value_; }
+  friend constexpr bool operator!=(Fixed a, Fixed b) { return a.value_ != b.value_; }
+  friend constexpr bool operator<(Fixed a, Fixed b) { return a.value_ < b.value_; }
+  friend constexpr bool operator<=(Fixed a, Fixed b) { return a.value_ <= b.value_; }
+  friend constexpr bool operator>(Fixed a, Fixed b) { return a.value_ > b.value_; }
+  friend constexpr bool operator>=(Fixed a, Fixed b) { return a.value_ >= b.value_; }
+
+private:
+  Storage value_ = 0;
+};
+
+using Q15 = Fixed<std::int16_t, std::int32_t, 15>;
+using Q31 = Fixed<std::int32_t, std::int64_t, 31>;
+
+template <class T>
+struct IsFixed : std::false_type
+{
+};
+
+template <class Storage, class Wide, int FractionalBits>
+struct IsFixed<Fixed<Storage, Wide, FractionalBits>> : std::true_type
+{
+};
+
+// A gain in 32 bits with 24 fractional bits, for scaling fixed-point samples by gains
+// of up to +-128, outside of the samples' range
+class FixedGain
+{
+public:
+  static constexpr int fractionalBits = 24;
+
+  constexpr FixedGain() = default;
+
+  explicit FixedGain(const double gain)
+  {
+    const auto scaled = std::round(gain * double(1 << fractionalBits));
+    const auto limit = double(std::numeric_limits<std::int32_t>::max());
+    multiplier_ = scaled >= limit ? std::numeric_limits<std::int32_t>::max()
+                  : scaled <= -limit ? -std::numeric_limits<std::int32_t>::max()
+                                     : std::int32_t(scaled);
+  }
+
+  constexpr std::int32_t multiplier() const { return multiplier_; }
+
+  // Scales a raw fixed-point value without saturating, with a single 32 x 32 -> 64 bit
+  // multiply for values of up to 32 bits
+  std::int64_t scale(const std::int64_t raw) const
+  {
+    return (raw * multiplier_ + (std::int64_t(1) << (fractionalBits - 1)))
+           >> fractionalBits;
+  }
+
+  template <class Storage, class Wide, int FractionalBits>
+  Fixed<Storage, Wide, FractionalBits> operator()(
+    const Fixed<Storage, Wide, FractionalBits> in) const
+  {
+    using Result = Fixed<Storage, Wide, FractionalBits>;
+    const auto scaled = scale(in.raw());
+    return Result::fromRaw(Storage(scaled > Result::maxRaw   ? Result::maxRaw
+                                   : scaled < Result::minRaw ? Result::minRaw
+                                                             : scaled));
+  }
+
+private:
+  std::int32_t multiplier_ = 1 << fractionalBits;
+};
+
+} // dsp
@@ -1,6 +1,11 @@
 #pragma once
 
+#include "chains/dsp/fixed_point.hpp"
+
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 
 namespace dsp
 {
@@ -12,10 +17,26 @@ struct Phasor {
   {}
 
   void setFrequency(const T frequency) {
+    frequency_ = frequency;
     inc_ = frequency / sampleRate_;
     assert(inc_ >= T(-1) && inc_ <= T(1));
   }
 
+  void setSampleRate(const double sampleRate) {
+    sampleRate_ = sampleRate;
+    setFrequency(frequency_);
+  }
+
+  void reset() {
+    phase_ = T(0);
+  }
+
+  // Passes the phase to a visitor, see chains/state.hpp
+  template <class Visitor>
+  void visitState(Visitor& visit) {
+    visit(&phase_, 1);
+  }
+
   auto tick() {
     phase_ += inc_;
 
@@ -28,10 +49,95 @@ struct Phasor {
     return phase_;
   }
 
+  // Fills a block with the phasor's output.
+  //
+  // The phase is found for each frame as a ramp from the phase at the start of each
+  // chunk, which is then wrapped by the number of times it has passed 1 or -1.
+  // Restarting the ramp every chunk keeps the error small for float phasors.
+  void process(T* out, const int numFrames) {
+    static const int chunkSize = 16;
+
+    for (auto offset = 0; offset < numFrames; offset += chunkSize) {
+      const auto frames = std::min(chunkSize, numFrames - offset);
+      const auto phase = phase_;
+      const auto inc = inc_;
+
+      for (auto i = 0; i < frames; ++i) {
+        const auto ramp = phase + T(i + 1) * inc;
+        out[offset + i] = ramp - std::max(std::floor(ramp), T(0))
+                          + std::max(std::floor(-ramp), T(0));
+      }
+
+      phase_ = out[offset + frames - 1];
+    }
+  }
+
 private:
   T phase_ = T(0);
   T inc_ = T(0);
-  const double sampleRate_;
+  T frequency_ = T(0);
+  double sampleRate_;
+};
+
+// Fixed-point phasors accumulate their phase in 64 bits with 32 fractional bits, so
+// the phase wraps exactly and low sample resolutions don't limit the frequency's
+// accuracy. The increment is only calculated in floating point when the frequency
+// changes.
+template<class Storage, class Wide, int FractionalBits>
+struct Phasor<Fixed<Storage, Wide, FractionalBits>> {
+  using T = Fixed<Storage, Wide, FractionalBits>;
+
+  static constexpr int phaseBits = 32;
+  static constexpr std::int64_t one = std::int64_t(1) << phaseBits;
+
+  Phasor(double sampleRate)
+    : sampleRate_(sampleRate)
+  {}
+
+  void setFrequency(const double frequency) {
+    frequency_ = frequency;
+    const auto inc = frequency / sampleRate_;
+    assert(inc >= -1.0 && inc <= 1.0);
+    inc_ = std::int64_t(std::round(inc * double(one)));
+  }
+
+  void setSampleRate(const double sampleRate) {
+    sampleRate_ = sampleRate;
+    setFrequency(frequency_);
+  }
+
+  void reset() {
+    phase_ = 0;
+  }
+
+  template <class Visitor>
+  void visitState(Visitor& visit) {
+    visit(&phase_, 1);
+  }
+
+  auto tick() {
+    phase_ += inc_;
+
+    if (phase_ >= one) {
+      phase_ -= one;
+    } else if (phase_ <= -one) {
+      phase_ += one;
+    }
+
+    return T::fromRaw(Storage(phase_ >> (phaseBits - FractionalBits)));
+  }
+
+  void process(T* out, const int numFrames) {
+    for (auto i = 0; i < numFrames; ++i) {
+      out[i] = tick();
+    }
+  }
+
+private:
+  std::int64_t phase_ = 0;
+  std::int64_t inc_ = 0;
+  double frequency_ = 0.0;
+  double sampleRate_;
 };
 
 } // dsp
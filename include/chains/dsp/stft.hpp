@@ -0,0 +1,155 @@
+#pragma once
+
+#include "chains/dsp/fft.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace dsp {
+
+// Returns a periodic square-root Hann window, shared with all other users of the same
+// size. Applied before and after processing, the windows combine to a Hann window.
+template <class T>
+std::shared_ptr<const std::vector<T>> sharedSqrtHannWindow(const int size)
+{
+  static std::mutex mutex;
+  static std::map<int, std::weak_ptr<const std::vector<T>>> windows;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto& cached = windows[size];
+  if (auto window = cached.lock()) {
+    return window;
+  }
+
+  auto window = std::make_shared<std::vector<T>>(size);
+  for (auto i = 0; i < size; ++i) {
+    (*window)[i] = T(std::sqrt(0.5 - 0.5 * std::cos(2.0 * M_PI * i / size)));
+  }
+
+  cached = window;
+  return window;
+}
+
+// A short-time Fourier transform with weighted overlap-add resynthesis.
+//
+// Every hop frames, the last fftSize frames of input are windowed and transformed,
+// the spectrum is passed to a bin processing function, and the result is transformed
+// back and added to the output.
+//
+// Each frame is processed on the tick that completes it, and its first hop samples,
+// which no later frame overlaps, are output from that tick on, so the latency is
+// fftSize - 1 frames. A sample is overlapped by frames ending up to fftSize - 1 frames
+// after it, so its output can't be complete any sooner.
+template <class T>
+class Stft
+{
+  int fftSize_;
+  int hop_;
+  int position_ = 0;
+  T scale_;
+  std::shared_ptr<const Fft<T>> fft_;
+  std::shared_ptr<const std::vector<T>> window_;
+  std::vector<T> input_;
+  std::vector<T> output_;
+  std::vector<T> frame_;
+  std::vector<T> re_;
+  std::vector<T> im_;
+
+public:
+  Stft(const int fftSize, const int hop)
+    : fftSize_(fftSize)
+    , hop_(hop)
+    , fft_(sharedFft<T>(fftSize))
+    , window_(sharedSqrtHannWindow<T>(fftSize))
+    , input_(fftSize)
+    , output_(fftSize)
+    , frame_(fftSize)
+    , re_(fft_->numBins())
+    , im_(fft_->numBins())
+  {
+    assert(hop > 0 && fftSize % hop == 0 && fftSize / hop >= 2);
+
+    // The overlapping analysis and synthesis windows sum to a constant
+    auto sum = 0.0;
+    for (auto i = 0; i < fftSize; i += hop) {
+      sum += double((*window_)[i]) * double((*window_)[i]);
+    }
+    scale_ = T(1.0 / sum);
+  }
+
+  int fftSize() const { return fftSize_; }
+  int hop() const { return hop_; }
+  int numBins() const { return fft_->numBins(); }
+  int latency() const { return fftSize_ - 1; }
+
+  // The FFT and the window are shared, so they aren't included
+  std::size_t heapSize() const
+  {
+    return (input_.capacity() + output_.capacity() + frame_.capacity() + re_.capacity()
+            + im_.capacity())
+           * sizeof(T);
+  }
+
+  void reset()
+  {
+    std::fill(input_.begin(), input_.end(), T(0));
+    std::fill(output_.begin(), output_.end(), T(0));
+    position_ = 0;
+  }
+
+  // Passes the input and output history to a visitor, see chains/state.hpp
+  template <class Visitor>
+  void visitState(Visitor& visit)
+  {
+    visit(&position_, 1);
+    visit(input_.data(), input_.size());
+    visit(output_.data(), output_.size());
+  }
+
+  // ProcessBins is called with the real and imaginary parts of each frame's bins
+  template <class ProcessBins>
+  T tick(const T in, ProcessBins&& processBins)
+  {
+    input_[fftSize_ - hop_ + position_] = in;
+
+    if (++position_ == hop_) {
+      processFrame(processBins);
+      position_ = 0;
+    }
+
+    return output_[position_];
+  }
+
+private:
+  template <class ProcessBins>
+  void processFrame(ProcessBins& processBins)
+  {
+    const auto& window = *window_;
+
+    for (auto i = 0; i < fftSize_; ++i) {
+      frame_[i] = input_[i] * window[i];
+    }
+
+    fft_->forward(frame_.data(), re_.data(), im_.data());
+    processBins(re_.data(), im_.data(), numBins());
+    fft_->inverse(re_.data(), im_.data(), frame_.data());
+
+    // Drop the frames that have been output, and add the new frame
+    std::copy(output_.begin() + hop_, output_.end(), output_.begin());
+    std::fill(output_.end() - hop_, output_.end(), T(0));
+    for (auto i = 0; i < fftSize_; ++i) {
+      output_[i] += frame_[i] * window[i] * scale_;
+    }
+
+    std::copy(input_.begin() + hop_, input_.end(), input_.begin());
+  }
+};
+
+} // dsp
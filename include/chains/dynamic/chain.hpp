@@ -0,0 +1,69 @@
+#pragma once
+
+#include "chains/dynamic/patch.hpp"
+
+#include <string>
+
+namespace chains {
+
+// A mono chain that's built at runtime from a patch, see dynamic/patch.hpp.
+//
+// Each node is called once per block through a virtual interface, and processes the
+// block with its module's processor or group, so the dispatch cost is shared by all of
+// the block's frames.
+template <class T>
+class DynamicChain
+{
+public:
+  // Builds the chain from a patch, replacing any previous chain. Returns false if the
+  // patch is invalid, with the reason available from error().
+  bool load(const std::string& patch,
+            const double sampleRate,
+            const dynamic::ModuleRegistry<T>& registry = dynamic::builtinModules<T>())
+  {
+    dynamic::PatchParser<T> parser(registry, sampleRate);
+    auto root = parser.parse(patch);
+    if (!root) {
+      error_ = parser.error();
+      return false;
+    }
+    if (root->numInputs() != 1 || root->numOutputs() != 1) {
+      error_ = "the patch needs to be mono";
+      return false;
+    }
+
+    root_ = std::move(root);
+    error_.clear();
+    return true;
+  }
+
+  const std::string& error() const { return error_; }
+
+  bool isLoaded() const { return root_ != nullptr; }
+
+  void prepare(const double sampleRate, const int maxBlockSize)
+  {
+    root_->prepare(sampleRate, maxBlockSize);
+  }
+
+  void reset() { root_->reset(); }
+
+  // Processes a block of samples, in and out may point to the same buffer
+  void process(const T* in, T* out, const int numFrames)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    root_->process(&in, &out, numFrames);
+  }
+
+  int latency() const { return root_->latency(); }
+
+  static const char* nodeName() { return "dynamic chain"; }
+
+  dynamic::Node<T>& root() { return *root_; }
+
+private:
+  dynamic::NodePtr<T> root_;
+  std::string error_;
+};
+
+} // chains
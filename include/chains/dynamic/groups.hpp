@@ -0,0 +1,269 @@
+#pragma once
+
+#include "chains/dynamic/node.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace chains {
+
+namespace dynamic {
+
+// Runs its nodes one after the other. Mono signals between the nodes are passed in
+// place in the output buffer when the chain's output is mono, and wider signals are
+// passed in buffers owned by the group.
+template <class T>
+class SerialNode : public Node<T>
+{
+public:
+  explicit SerialNode(std::vector<NodePtr<T>> nodes) : nodes_(std::move(nodes))
+  {
+    assert(!nodes_.empty());
+  }
+
+  int numInputs() const override { return nodes_.front()->numInputs(); }
+  int numOutputs() const override { return nodes_.back()->numOutputs(); }
+
+  void prepare(const double sampleRate, const int maxBlockSize) override
+  {
+    for (auto& node : nodes_) {
+      node->prepare(sampleRate, maxBlockSize);
+    }
+
+    const auto inPlace = numOutputs() == 1;
+    auto numBuffers = 0;
+    for (auto i = 0; i + 1 < int(nodes_.size()); ++i) {
+      const auto width = nodes_[i]->numOutputs();
+      numBuffers += inPlace && width == 1 ? 0 : width;
+    }
+
+    buffer_.assign(std::size_t(numBuffers) * maxBlockSize, T(0));
+    links_.assign(nodes_.size() - 1, {});
+    auto next = buffer_.data();
+    for (auto i = 0; i + 1 < int(nodes_.size()); ++i) {
+      const auto width = nodes_[i]->numOutputs();
+      if (inPlace && width == 1) {
+        continue;
+      }
+      for (auto channel = 0; channel < width; ++channel) {
+        links_[i].push_back(next);
+        next += maxBlockSize;
+      }
+    }
+  }
+
+  void reset() override
+  {
+    for (auto& node : nodes_) {
+      node->reset();
+    }
+  }
+
+  static const char* nodeName() { return "serial"; }
+
+  void process(const T* const* in, T* const* out, const int numFrames) override
+  {
+    const chains::detail::RealtimeScope scope{nodeName()};
+    for (auto i = 0; i < int(nodes_.size()); ++i) {
+      const auto isLast = i + 1 == int(nodes_.size());
+      const auto target = isLast || links_[i].empty() ? out : links_[i].data();
+      nodes_[i]->process(in, target, numFrames);
+      in = target;
+    }
+  }
+
+  // The nodes' latencies add up
+  int latency() const override
+  {
+    auto latency = 0;
+    for (const auto& node : nodes_) {
+      latency += node->latency();
+    }
+    return latency;
+  }
+
+private:
+  std::vector<NodePtr<T>> nodes_;
+  std::vector<T> buffer_;
+  // The buffers for the signal after each node but the last, empty for mono signals
+  // that are passed in the output buffer
+  std::vector<std::vector<T*>> links_;
+};
+
+// Sums the outputs of its mono nodes, which all receive the same input
+template <class T>
+class ParallelNode : public Node<T>
+{
+public:
+  explicit ParallelNode(std::vector<NodePtr<T>> nodes) : nodes_(std::move(nodes))
+  {
+    assert(!nodes_.empty());
+  }
+
+  int numInputs() const override { return 1; }
+  int numOutputs() const override { return 1; }
+
+  void prepare(const double sampleRate, const int maxBlockSize) override
+  {
+    for (auto& node : nodes_) {
+      node->prepare(sampleRate, maxBlockSize);
+    }
+    sum_.assign(maxBlockSize, T(0));
+    branch_.assign(maxBlockSize, T(0));
+  }
+
+  void reset() override
+  {
+    for (auto& node : nodes_) {
+      node->reset();
+    }
+  }
+
+  static const char* nodeName() { return "parallel"; }
+
+  void process(const T* const* in, T* const* out, const int numFrames) override
+  {
+    const chains::detail::RealtimeScope scope{nodeName()};
+    // The input needs to stay intact until the last node has run, so the sum only
+    // goes directly to the output when it isn't shared with the input
+    T* sum = in[0] == out[0] ? sum_.data() : out[0];
+    T* branch = branch_.data();
+
+    nodes_.front()->process(in, &sum, numFrames);
+    for (auto i = 1; i < int(nodes_.size()); ++i) {
+      nodes_[i]->process(in, &branch, numFrames);
+      for (auto frame = 0; frame < numFrames; ++frame) {
+        sum[frame] += branch[frame];
+      }
+    }
+
+    if (sum != out[0]) {
+      std::copy_n(sum, numFrames, out[0]);
+    }
+  }
+
+  // The latency of the slowest node, the nodes aren't aligned with each other
+  int latency() const override
+  {
+    auto latency = 0;
+    for (const auto& node : nodes_) {
+      latency = std::max(latency, node->latency());
+    }
+    return latency;
+  }
+
+private:
+  std::vector<NodePtr<T>> nodes_;
+  std::vector<T> sum_;
+  std::vector<T> branch_;
+};
+
+// Fans a mono input out to its mono nodes, each node writes directly to its own output
+template <class T>
+class SplitNode : public Node<T>
+{
+public:
+  explicit SplitNode(std::vector<NodePtr<T>> nodes) : nodes_(std::move(nodes))
+  {
+    assert(!nodes_.empty());
+  }
+
+  int numInputs() const override { return 1; }
+  int numOutputs() const override { return int(nodes_.size()); }
+
+  void prepare(const double sampleRate, const int maxBlockSize) override
+  {
+    for (auto& node : nodes_) {
+      node->prepare(sampleRate, maxBlockSize);
+    }
+  }
+
+  void reset() override
+  {
+    for (auto& node : nodes_) {
+      node->reset();
+    }
+  }
+
+  // The nodes run in reverse order, so the input can share a buffer with the first
+  // output
+  static const char* nodeName() { return "split"; }
+
+  void process(const T* const* in, T* const* out, const int numFrames) override
+  {
+    const chains::detail::RealtimeScope scope{nodeName()};
+    for (auto i = int(nodes_.size()) - 1; i >= 0; --i) {
+      nodes_[i]->process(in, out + i, numFrames);
+    }
+  }
+
+  // The latency of the slowest node, the outputs aren't aligned with each other
+  int latency() const override
+  {
+    auto latency = 0;
+    for (const auto& node : nodes_) {
+      latency = std::max(latency, node->latency());
+    }
+    return latency;
+  }
+
+private:
+  std::vector<NodePtr<T>> nodes_;
+};
+
+// Feeds the output of the back node into the input of the forward node, with a single
+// sample delay. The loop is processed one frame at a time, so unlike the other groups
+// its nodes are called per sample.
+template <class T>
+class RecursiveNode : public Node<T>
+{
+public:
+  RecursiveNode(NodePtr<T> forward, NodePtr<T> back)
+    : forward_(std::move(forward)), back_(std::move(back))
+  {
+  }
+
+  int numInputs() const override { return 1; }
+  int numOutputs() const override { return 1; }
+
+  void prepare(const double sampleRate, const int maxBlockSize) override
+  {
+    forward_->prepare(sampleRate, maxBlockSize);
+    back_->prepare(sampleRate, maxBlockSize);
+  }
+
+  void reset() override
+  {
+    forward_->reset();
+    back_->reset();
+    previous_ = T(0);
+  }
+
+  static const char* nodeName() { return "recursive"; }
+
+  void process(const T* const* in, T* const* out, const int numFrames) override
+  {
+    const chains::detail::RealtimeScope scope{nodeName()};
+    for (auto i = 0; i < numFrames; ++i) {
+      auto sample = in[0][i] + previous_;
+      auto* frame = &sample;
+      forward_->process(&frame, &frame, 1);
+      out[0][i] = sample;
+      back_->process(&frame, &frame, 1);
+      previous_ = sample;
+    }
+  }
+
+  // Only the forward node's latency delays the output
+  int latency() const override { return forward_->latency(); }
+
+private:
+  NodePtr<T> forward_;
+  NodePtr<T> back_;
+  T previous_ = T(0);
+};
+
+} // dynamic
+
+} // chains
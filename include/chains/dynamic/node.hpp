@@ -0,0 +1,241 @@
+#pragma once
+
+#include "chains/bus.hpp"
+#include "chains/module.hpp"
+
+#include <boost/hana/for_each.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chains {
+
+namespace dynamic {
+
+// A processor in a chain that's built at runtime.
+//
+// Nodes are called through a virtual interface, so they only process blocks, and the
+// cost of the call is shared by all of the block's frames. Signals between nodes have
+// one or more channels, e.g. a split outputs a channel for each of its branches.
+template <class T>
+class Node
+{
+public:
+  virtual ~Node() = default;
+
+  virtual int numInputs() const = 0;
+  virtual int numOutputs() const = 0;
+
+  // Allocates any memory needed for processing blocks of up to maxBlockSize frames
+  virtual void prepare(double sampleRate, int maxBlockSize) = 0;
+
+  virtual void reset() = 0;
+
+  // Processes a block from numInputs input buffers into numOutputs output buffers.
+  // Mono nodes can process in place, with in[0] and out[0] pointing to the same buffer.
+  virtual void process(const T* const* in, T* const* out, int numFrames) = 0;
+
+  virtual int latency() const = 0;
+
+  // Parameters are found by name, ignoring case
+  virtual bool hasParameter(const std::string& /* name */) const { return false; }
+
+  // Returns false if there's no such parameter
+  virtual bool setParameter(const std::string& /* name */, double /* value */)
+  {
+    return false;
+  }
+};
+
+template <class T>
+using NodePtr = std::unique_ptr<Node<T>>;
+
+// Initial values for a module's parameters, by name
+using ParameterValues = std::vector<std::pair<std::string, double>>;
+
+namespace detail {
+
+inline bool namesMatch(const std::string& a, const char* b)
+{
+  auto i = std::size_t(0);
+  for (; i < a.size() && b[i] != '\0'; ++i) {
+    if (std::tolower(static_cast<unsigned char>(a[i]))
+        != std::tolower(static_cast<unsigned char>(b[i]))) {
+      return false;
+    }
+  }
+  return i == a.size() && b[i] == '\0';
+}
+
+template <class Parameters>
+struct ExposeAll;
+
+template <class... Parameters>
+struct ExposeAll<ParameterTraits<Parameters...>>
+{
+  static std::vector<const char*> names() { return {Parameters::name()...}; }
+
+  // Makes a processor with all of the module's parameters exposed, starting at the
+  // given values
+  template <class ModuleTraits, class T>
+  static auto makeProcessor(const double sampleRate, const ParameterValues& values)
+  {
+    auto initial = std::vector<double>{Parameters::defaultValue()...};
+    const auto parameterNames = names();
+    for (const auto& value : values) {
+      for (auto i = std::size_t(0); i < parameterNames.size(); ++i) {
+        if (namesMatch(value.first, parameterNames[i])) {
+          initial[i] = value.second;
+        }
+      }
+    }
+    return makeProcessor<ModuleTraits, T>(sampleRate, initial,
+                                          std::index_sequence_for<Parameters...>{});
+  }
+
+private:
+  template <class ModuleTraits, class T, std::size_t... Index>
+  static auto makeProcessor(const double sampleRate,
+                            const std::vector<double>& initial,
+                            std::index_sequence<Index...>)
+  {
+    return module<ModuleTraits, Expose<Parameters...>>(Value<Parameters>(initial[Index])...)
+      .template makeProcessor<T>(sampleRate);
+  }
+};
+
+const int maxInputWidth = 8;
+
+// The number of channels that a processor mixes down, 0 if it doesn't take planar input
+template <class Processor, class T, int Width>
+struct PlanarInputWidth
+  : std::conditional_t<canApply<chains::detail::CheckForPlanarTick,
+                                Processor,
+                                T,
+                                std::integral_constant<int, Width>>::value,
+                       std::integral_constant<int, Width>,
+                       PlanarInputWidth<Processor, T, Width + 1>>
+{
+};
+
+template <class Processor, class T>
+struct PlanarInputWidth<Processor, T, maxInputWidth + 1> : std::integral_constant<int, 0>
+{
+};
+
+template <class Processor, class T>
+struct InputWidth : std::conditional_t<isMonoProcessor<Processor, T>,
+                                       std::integral_constant<int, 1>,
+                                       PlanarInputWidth<Processor, T, 2>>
+{
+};
+
+} // detail
+
+// A node that hosts a module's processor, with all of the module's parameters exposed
+// so that they can be set by name
+template <class T, class Host>
+class ModuleNode : public Node<T>
+{
+  static constexpr int inputWidth = detail::InputWidth<Host, T>::value;
+  static_assert(inputWidth > 0, "Module processors need to output single samples");
+
+public:
+  ModuleNode(Host host, const std::vector<const char*>& names) : host_(std::move(host))
+  {
+    host_.init();
+
+    auto index = std::size_t(0);
+    boost::hana::for_each(host_.exposedInputs(), [&](auto* input) {
+      using Input = std::remove_pointer_t<decltype(input)>;
+      parameters_.push_back({names[index++], input, [](void* target, double value) {
+                               static_cast<Input*>(target)->setValue(value);
+                             }});
+    });
+  }
+
+  ModuleNode(const ModuleNode&) = delete;
+  ModuleNode& operator=(const ModuleNode&) = delete;
+
+  int numInputs() const override { return inputWidth; }
+  int numOutputs() const override { return 1; }
+
+  void prepare(const double sampleRate, const int maxBlockSize) override
+  {
+    host_.prepare(sampleRate, maxBlockSize);
+  }
+
+  void reset() override { host_.reset(); }
+
+  void process(const T* const* in, T* const* out, const int numFrames) override
+  {
+    const chains::detail::RealtimeScope scope{host_.nodeName()};
+    processBlock(in, out[0], numFrames, std::integral_constant<bool, inputWidth == 1>{});
+  }
+
+  int latency() const override { return host_.latency(); }
+
+  bool hasParameter(const std::string& name) const override
+  {
+    return std::any_of(parameters_.begin(), parameters_.end(), [&](const NamedInput& input) {
+      return detail::namesMatch(name, input.name);
+    });
+  }
+
+  bool setParameter(const std::string& name, const double value) override
+  {
+    for (const auto& parameter : parameters_) {
+      if (detail::namesMatch(name, parameter.name)) {
+        parameter.setValue(parameter.input, value);
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  void processBlock(const T* const* in, T* out, int numFrames, std::true_type)
+  {
+    host_.process(in[0], out, numFrames);
+  }
+
+  void processBlock(const T* const* in, T* out, int numFrames, std::false_type)
+  {
+    auto channels = std::array<const T*, inputWidth>{};
+    std::copy_n(in, inputWidth, channels.begin());
+    host_.process(Bus<const T, inputWidth>::planar(channels, numFrames), out, numFrames);
+  }
+
+  struct NamedInput
+  {
+    const char* name;
+    void* input;
+    // Calls the input's setValue, without needing to know the input's type
+    void (*setValue)(void* input, double value);
+  };
+
+  Host host_;
+  std::vector<NamedInput> parameters_;
+};
+
+// Makes a node for a module, with its parameters starting at the given values or at
+// their defaults. Values for parameters that the module doesn't have are ignored.
+template <class ModuleTraits, class T>
+NodePtr<T> makeModuleNode(const double sampleRate, const ParameterValues& values)
+{
+  using Parameters = typename chains::detail::ModuleParameters<ModuleTraits>::type;
+  using Exposed = detail::ExposeAll<Parameters>;
+
+  auto host = Exposed::template makeProcessor<ModuleTraits, T>(sampleRate, values);
+  return std::make_unique<ModuleNode<T, decltype(host)>>(std::move(host), Exposed::names());
+}
+
+} // dynamic
+
+} // chains
@@ -0,0 +1,291 @@
+#pragma once
+
+#include "chains/dynamic/groups.hpp"
+#include "chains/dynamic/node.hpp"
+#include "chains/modules/accumulator.hpp"
+#include "chains/modules/biquad.hpp"
+#include "chains/modules/crossfade.hpp"
+#include "chains/modules/delay.hpp"
+#include "chains/modules/gain.hpp"
+#include "chains/modules/ones.hpp"
+#include "chains/modules/phasor.hpp"
+#include "chains/modules/wire.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace chains {
+
+namespace dynamic {
+
+// The modules that can be used in patches, by name
+template <class T>
+class ModuleRegistry
+{
+public:
+  using Factory = NodePtr<T> (*)(double sampleRate, const ParameterValues& values);
+
+  template <class ModuleTraits>
+  void add(const std::string& name)
+  {
+    factories_[name] = &makeModuleNode<ModuleTraits, T>;
+  }
+
+  bool contains(const std::string& name) const { return factories_.count(name) > 0; }
+
+  // Makes a node for the named module, or returns nullptr if there's no such module
+  NodePtr<T> make(const std::string& name,
+                  const double sampleRate,
+                  const ParameterValues& values = {}) const
+  {
+    const auto factory = factories_.find(name);
+    return factory != factories_.end() ? factory->second(sampleRate, values) : nullptr;
+  }
+
+private:
+  std::map<std::string, Factory> factories_;
+};
+
+// A registry of the built-in modules that don't need any setup beyond their parameters
+template <class T>
+ModuleRegistry<T> builtinModules()
+{
+  auto registry = ModuleRegistry<T>{};
+  registry.template add<Accumulator>("accumulator");
+  registry.template add<Biquad>("biquad");
+  registry.template add<Crossfade>("crossfade");
+  registry.template add<Delay>("delay");
+  registry.template add<Gain>("gain");
+  registry.template add<Ones>("ones");
+  registry.template add<Phasor>("phasor");
+  registry.template add<Wire>("wire");
+  return registry;
+}
+
+// Builds nodes from patches, text descriptions of chains that mirror the way that
+// chains are declared in code, e.g.
+//
+//   serial(gain(gain = 0.5),
+//          split(biquad(frequency = 500, q = 2), delay(length = 10)),
+//          crossfade(fade = 0.25))
+//
+// Groups are serial, parallel, split and recursive, anything else is a module from the
+// registry, with its parameters set by name. Names are lower case, parameter names
+// ignore case, and comments start with # and run to the end of the line.
+template <class T>
+class PatchParser
+{
+public:
+  PatchParser(const ModuleRegistry<T>& registry, const double sampleRate)
+    : registry_(registry), sampleRate_(sampleRate)
+  {
+  }
+
+  // Returns the patch's root node, or nullptr if the patch is invalid
+  NodePtr<T> parse(const std::string& patch)
+  {
+    patch_ = patch;
+    position_ = 0;
+    error_.clear();
+
+    auto root = parseNode();
+    if (root) {
+      skipWhitespace();
+      if (position_ != patch_.size()) {
+        fail("unexpected text after the patch");
+        return nullptr;
+      }
+    }
+    return root;
+  }
+
+  const std::string& error() const { return error_; }
+
+private:
+  NodePtr<T> parseNode()
+  {
+    std::string name;
+    if (!parseIdentifier(name) || !expect('(')) {
+      return nullptr;
+    }
+
+    if (name == "serial" || name == "parallel" || name == "split" || name == "recursive") {
+      return parseGroup(name);
+    }
+
+    if (!registry_.contains(name)) {
+      fail("unknown module '" + name + "'");
+      return nullptr;
+    }
+    return parseModule(name);
+  }
+
+  NodePtr<T> parseGroup(const std::string& name)
+  {
+    std::vector<NodePtr<T>> nodes;
+    if (!peek(')')) {
+      do {
+        auto node = parseNode();
+        if (!node) {
+          return nullptr;
+        }
+        nodes.push_back(std::move(node));
+      } while (accept(','));
+    }
+    if (!expect(')')) {
+      return nullptr;
+    }
+
+    if (nodes.empty()) {
+      fail(name + " needs at least one node");
+      return nullptr;
+    }
+
+    if (name == "serial") {
+      for (auto i = 1; i < int(nodes.size()); ++i) {
+        if (nodes[i - 1]->numOutputs() != nodes[i]->numInputs()) {
+          fail("serial node " + std::to_string(i + 1) + " takes "
+               + std::to_string(nodes[i]->numInputs()) + " channels, but receives "
+               + std::to_string(nodes[i - 1]->numOutputs()));
+          return nullptr;
+        }
+      }
+      return std::make_unique<SerialNode<T>>(std::move(nodes));
+    }
+
+    for (const auto& node : nodes) {
+      if (node->numInputs() != 1 || node->numOutputs() != 1) {
+        fail(name + " nodes need to be mono");
+        return nullptr;
+      }
+    }
+
+    if (name == "parallel") {
+      return std::make_unique<ParallelNode<T>>(std::move(nodes));
+    }
+    if (name == "split") {
+      return std::make_unique<SplitNode<T>>(std::move(nodes));
+    }
+
+    if (nodes.size() != 2) {
+      fail("recursive needs a forward and a back node");
+      return nullptr;
+    }
+    return std::make_unique<RecursiveNode<T>>(std::move(nodes[0]), std::move(nodes[1]));
+  }
+
+  // The parameters are set when the module is made, so that processors that smooth
+  // their parameters start at the patch's values
+  NodePtr<T> parseModule(const std::string& name)
+  {
+    ParameterValues values;
+    if (!peek(')')) {
+      do {
+        std::string parameter;
+        auto value = 0.0;
+        if (!parseIdentifier(parameter) || !expect('=') || !parseNumber(value)) {
+          return nullptr;
+        }
+        values.emplace_back(parameter, value);
+      } while (accept(','));
+    }
+    if (!expect(')')) {
+      return nullptr;
+    }
+
+    auto node = registry_.make(name, sampleRate_, values);
+    for (const auto& value : values) {
+      if (!node->hasParameter(value.first)) {
+        fail(name + " has no parameter '" + value.first + "'");
+        return nullptr;
+      }
+    }
+    return node;
+  }
+
+  bool parseIdentifier(std::string& identifier)
+  {
+    skipWhitespace();
+    const auto start = position_;
+    while (position_ < patch_.size()
+           && (std::isalnum(static_cast<unsigned char>(patch_[position_]))
+               || patch_[position_] == '_')) {
+      ++position_;
+    }
+    if (position_ == start) {
+      return fail("expected a name");
+    }
+    identifier = patch_.substr(start, position_ - start);
+    return true;
+  }
+
+  bool parseNumber(double& value)
+  {
+    skipWhitespace();
+    const auto start = patch_.c_str() + position_;
+    char* end = nullptr;
+    value = std::strtod(start, &end);
+    if (end == start) {
+      return fail("expected a number");
+    }
+    position_ += std::size_t(end - start);
+    return true;
+  }
+
+  void skipWhitespace()
+  {
+    while (position_ < patch_.size()) {
+      if (patch_[position_] == '#') {
+        while (position_ < patch_.size() && patch_[position_] != '\n') {
+          ++position_;
+        }
+      } else if (std::isspace(static_cast<unsigned char>(patch_[position_]))) {
+        ++position_;
+      } else {
+        break;
+      }
+    }
+  }
+
+  bool peek(const char c)
+  {
+    skipWhitespace();
+    return position_ < patch_.size() && patch_[position_] == c;
+  }
+
+  bool accept(const char c)
+  {
+    if (peek(c)) {
+      ++position_;
+      return true;
+    }
+    return false;
+  }
+
+  bool expect(const char c)
+  {
+    return accept(c) || fail(std::string{"expected '"} + c + "'");
+  }
+
+  // Records an error at the current line, always returning false
+  bool fail(const std::string& message)
+  {
+    const auto line = 1 + std::count(patch_.begin(), patch_.begin() + position_, '\n');
+    error_ = "line " + std::to_string(line) + ": " + message;
+    return false;
+  }
+
+  const ModuleRegistry<T>& registry_;
+  double sampleRate_;
+  std::string patch_;
+  std::size_t position_ = 0;
+  std::string error_;
+};
+
+} // dynamic
+
+} // chains
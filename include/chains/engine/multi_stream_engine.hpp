@@ -0,0 +1,256 @@
+#pragma once
+
+#include "chains/engine/thread.hpp"
+#include "chains/realtime_check.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chains {
+
+// Runs many independent streams, each with its own copy of a prototype processor, on
+// a fixed set of worker threads.
+//
+// Each stream has a home worker, which creates the stream's processor and buffers so
+// that they're allocated local to the worker's core, and which processes the stream
+// whenever it can. A worker that runs out of its own streams steals streams from the
+// other workers, so that the load stays balanced when streams take different amounts
+// of time to process. Streams are claimed by incrementing each worker's shared queue
+// position, so claiming a stream doesn't need a lock.
+//
+// Every call to process() processes a block for all streams, and has a deadline of
+// one block's duration. Streams that finish processing after the deadline are counted
+// as deadline misses.
+template <class T, class Processor>
+class MultiStreamEngine
+{
+public:
+  struct Options
+  {
+    int numWorkers = int(std::max(1u, std::thread::hardware_concurrency()));
+    int blockSize = 256;
+    double sampleRate = 48e3;
+    // Pins each worker to a core, worker i running on core i modulo the core count
+    bool pinWorkers = true;
+  };
+
+  MultiStreamEngine(const Processor& prototype, const int numStreams, Options options)
+    : options_(options)
+    , streams_(numStreams)
+    , workers_(std::max(1, options.numWorkers))
+    , period_(std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.blockSize / options.sampleRate)))
+  {
+    const auto numWorkers = int(workers_.size());
+    for (auto w = 0; w < numWorkers; ++w) {
+      workers_[w].begin = int(std::int64_t(numStreams) * w / numWorkers);
+      workers_[w].end = int(std::int64_t(numStreams) * (w + 1) / numWorkers);
+      workers_[w].next.store(workers_[w].end);
+    }
+
+    for (auto w = 0; w < numWorkers; ++w) {
+      threads_.emplace_back([this, w, &prototype] { runWorker(w, prototype); });
+    }
+
+    // The prototype is only used while the workers are creating their streams
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] { return numReady_ == int(workers_.size()); });
+  }
+
+  MultiStreamEngine(const MultiStreamEngine&) = delete;
+  MultiStreamEngine& operator=(const MultiStreamEngine&) = delete;
+
+  ~MultiStreamEngine()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    condition_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  int numStreams() const { return int(streams_.size()); }
+  int numWorkers() const { return int(workers_.size()); }
+  int blockSize() const { return options_.blockSize; }
+
+  // The stream's input and output blocks, which can be accessed between calls to
+  // process()
+  T* input(const int stream) { return streams_[stream]->input.data(); }
+  const T* output(const int stream) const { return streams_[stream]->output.data(); }
+
+  Processor& processor(const int stream) { return streams_[stream]->processor; }
+
+  static const char* nodeName() { return "multi-stream engine"; }
+
+  // Processes a block for every stream, returning when all streams are done
+  void process()
+  {
+    const auto numWorkers = int(workers_.size());
+    for (auto w = 0; w < numWorkers; ++w) {
+      workers_[w].next.store(workers_[w].begin, std::memory_order_relaxed);
+    }
+    busyWorkers_.store(numWorkers, std::memory_order_relaxed);
+    deadline_ = Clock::now() + period_;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++cycle_;
+    }
+    condition_.notify_all();
+
+    // Waiting for every worker, rather than for every stream, makes sure that no
+    // worker is still reading the queues when they're reset for the next block
+    while (busyWorkers_.load(std::memory_order_acquire) > 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  std::int64_t deadlineMisses(const int stream) const
+  {
+    return streams_[stream]->deadlineMisses;
+  }
+
+  std::int64_t totalDeadlineMisses() const
+  {
+    std::int64_t total = 0;
+    for (const auto& stream : streams_) {
+      total += stream->deadlineMisses;
+    }
+    return total;
+  }
+
+  // The number of streams that have been processed by a worker other than their home
+  std::int64_t numSteals() const
+  {
+    std::int64_t total = 0;
+    for (const auto& worker : workers_) {
+      total += worker.steals.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Stream
+  {
+    Stream(const Processor& prototype, const Options& options)
+      : processor(prototype)
+      , input(options.blockSize)
+      , output(options.blockSize)
+    {
+      processor.prepare(options.sampleRate, options.blockSize);
+    }
+
+    Processor processor;
+    std::vector<T> input;
+    std::vector<T> output;
+    std::int64_t deadlineMisses = 0;
+  };
+
+  // Each worker's queue position is on its own cache line, as it's shared with thieves
+  struct alignas(64) Worker
+  {
+    std::atomic<int> next{0};
+    int begin = 0;
+    int end = 0;
+    std::atomic<std::int64_t> steals{0};
+  };
+
+  void runWorker(const int index, const Processor& prototype)
+  {
+    auto& worker = workers_[index];
+
+    if (options_.pinWorkers) {
+      pinCurrentThreadToCore(index);
+    }
+
+    for (auto i = worker.begin; i < worker.end; ++i) {
+      streams_[i] = std::make_unique<Stream>(prototype, options_);
+    }
+
+    auto seenCycle = std::uint64_t(0);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++numReady_;
+    }
+    condition_.notify_all();
+
+    const auto numWorkers = int(workers_.size());
+
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [&] { return cycle_ != seenCycle || stopping_; });
+        if (stopping_) {
+          return;
+        }
+        seenCycle = cycle_;
+      }
+
+      runQueue(worker);
+
+      // Steal from the other workers, starting with the next one along to spread
+      // the thieves out
+      for (auto offset = 1; offset < numWorkers; ++offset) {
+        const auto stolen = runQueue(workers_[(index + offset) % numWorkers]);
+        if (stolen > 0) {
+          worker.steals.fetch_add(stolen, std::memory_order_relaxed);
+        }
+      }
+
+      busyWorkers_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+
+  // Processes streams from a worker's queue until it's empty, returning the number of
+  // streams that were processed
+  int runQueue(Worker& queue)
+  {
+    auto count = 0;
+    for (;;) {
+      const auto stream = queue.next.fetch_add(1, std::memory_order_relaxed);
+      if (stream >= queue.end) {
+        return count;
+      }
+
+      auto& state = *streams_[stream];
+      {
+        const detail::RealtimeScope scope{nodeName()};
+        state.processor.process(
+          state.input.data(), state.output.data(), options_.blockSize);
+      }
+      if (Clock::now() > deadline_) {
+        ++state.deadlineMisses;
+      }
+
+      ++count;
+    }
+  }
+
+  Options options_;
+  std::vector<std::unique_ptr<Stream>> streams_;
+  std::vector<Worker> workers_;
+  std::vector<std::thread> threads_;
+  Clock::duration period_;
+  Clock::time_point deadline_;
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::uint64_t cycle_ = 0;
+  int numReady_ = 0;
+  bool stopping_ = false;
+  std::atomic<int> busyWorkers_{0};
+};
+
+} // chains
@@ -0,0 +1,321 @@
+#pragma once
+
+#include "chains/engine/spsc_queue.hpp"
+#include "chains/engine/thread.hpp"
+#include "chains/io/audio_file.hpp"
+#include "chains/realtime_check.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+
+namespace chains {
+
+// Timing statistics gathered while running a real-time engine
+struct RealtimeStats
+{
+  // Callback durations are counted in bins of 5% of the block's period, with the last
+  // bin counting callbacks that took longer than the period
+  static constexpr int numHistogramBins = 21;
+  static constexpr double histogramBinWidth = 0.05;
+
+  std::int64_t numCallbacks = 0;
+  // Callbacks that finished after their deadline
+  std::int64_t numXruns = 0;
+  // The most that a callback started after its scheduled time, in seconds
+  double maxJitter = 0.0;
+  double maxCallbackTime = 0.0;
+  double totalCallbackTime = 0.0;
+  // Output blocks that weren't written to the WAV file because the writer fell behind
+  std::int64_t numDroppedBlocks = 0;
+  // Whether the engine's thread was given SCHED_FIFO scheduling
+  bool realtimePriority = false;
+  std::array<std::int64_t, numHistogramBins> histogram{};
+
+  double meanCallbackTime() const
+  {
+    return numCallbacks > 0 ? totalCallbackTime / numCallbacks : 0.0;
+  }
+};
+
+// A device without audio hardware, which wakes the engine at the start of each
+// block's period using the monotonic clock
+class NullDevice
+{
+  timespec next_{};
+  long periodNanoseconds_;
+
+public:
+  explicit NullDevice(const double period)
+    : periodNanoseconds_(long(period * 1e9))
+  {
+  }
+
+  void start() { clock_gettime(CLOCK_MONOTONIC, &next_); }
+
+  // Waits for the start of the next period, returning how late the wake up was
+  double wait()
+  {
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next_, nullptr);
+    const auto lateness = secondsSince(next_);
+    advance();
+    return lateness;
+  }
+
+  // The time remaining until the next period starts, negative if it has passed
+  double timeUntilNextPeriod() const { return -secondsSince(next_); }
+
+  // Skips any periods that have already passed, as a device does after an xrun
+  void resynchronize()
+  {
+    while (timeUntilNextPeriod() < 0.0) {
+      advance();
+    }
+  }
+
+private:
+  void advance()
+  {
+    next_.tv_nsec += periodNanoseconds_;
+    while (next_.tv_nsec >= 1000000000L) {
+      next_.tv_nsec -= 1000000000L;
+      ++next_.tv_sec;
+    }
+  }
+
+  static double secondsSince(const timespec& time)
+  {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return double(now.tv_sec - time.tv_sec) + double(now.tv_nsec - time.tv_nsec) * 1e-9;
+  }
+};
+
+// Runs a processor under real-time conditions, for load testing without audio
+// hardware.
+//
+// The processor's block callback is run on a dedicated thread, clocked by a null
+// device at the block's period, and is given a block of noise as input so that
+// silence detection doesn't skip any processing. Each callback's duration is recorded
+// against its deadline, the end of its period.
+//
+// Optionally the output is written to a WAV file. Writing to the file isn't real-time
+// safe, so the engine's thread passes output blocks through a queue to a writer thread,
+// which drains them into the file once per period. Blocks are dropped if the writer
+// falls behind by more than outputBlocks blocks.
+template <class T, class Processor>
+class RealtimeEngine
+{
+public:
+  struct Options
+  {
+    int blockSize = 256;
+    double sampleRate = 48e3;
+    // SCHED_FIFO is requested at this priority, falling back to normal scheduling
+    bool realtimePriority = true;
+    int priority = 80;
+    // The core to pin the engine's thread to, or -1 to leave it unpinned
+    int core = -1;
+    // A WAV file to write the output to, or empty for no output
+    std::string wavPath;
+    // The number of output blocks that can wait to be written to the WAV file
+    int outputBlocks = 64;
+  };
+
+  RealtimeEngine(Processor& processor, Options options)
+    : processor_(processor)
+    , options_(options)
+    , input_(options.blockSize)
+    , output_(options.blockSize)
+    , freeBlocks_(options.wavPath.empty() ? 1 : options.outputBlocks)
+    , filledBlocks_(options.wavPath.empty() ? 1 : options.outputBlocks)
+  {
+    auto seed = 1u;
+    for (auto& sample : input_) {
+      seed = seed * 1664525u + 1013904223u;
+      sample = T((double(seed >> 8) / double(1 << 24) - 0.5) * 0.5);
+    }
+
+    if (!options.wavPath.empty()) {
+      outputBlocks_.assign(options.outputBlocks, std::vector<T>(options.blockSize));
+      for (auto& block : outputBlocks_) {
+        freeBlocks_.push(block.data());
+      }
+    }
+  }
+
+  RealtimeEngine(const RealtimeEngine&) = delete;
+  RealtimeEngine& operator=(const RealtimeEngine&) = delete;
+
+  ~RealtimeEngine() { stop(); }
+
+  // Starts running the processor, for numBlocks blocks or until stop is called if
+  // numBlocks is negative. Returns false if the WAV file couldn't be created.
+  bool start(const std::int64_t numBlocks = -1)
+  {
+    stop();
+
+    processor_.prepare(options_.sampleRate, options_.blockSize);
+
+    if (!options_.wavPath.empty()) {
+      writer_ = std::make_unique<io::WavFileWriter>();
+      if (!writer_->open(options_.wavPath, 1, options_.sampleRate)) {
+        writer_.reset();
+        return false;
+      }
+    }
+
+    stats_ = RealtimeStats{};
+    running_ = true;
+    processing_ = true;
+    if (writer_) {
+      writerThread_ = std::thread([this] { runWriter(); });
+    }
+    thread_ = std::thread([this, numBlocks] { runLoop(numBlocks); });
+    return true;
+  }
+
+  // Stops the engine, and completes the WAV file if there is one
+  void stop()
+  {
+    running_ = false;
+    join();
+  }
+
+  // Runs numBlocks blocks, and returns once they're done
+  bool runFor(const std::int64_t numBlocks)
+  {
+    if (!start(numBlocks)) {
+      return false;
+    }
+    join();
+    return true;
+  }
+
+  // The statistics are complete once the engine has stopped
+  const RealtimeStats& stats() const { return stats_; }
+
+  static const char* nodeName() { return "realtime engine"; }
+
+private:
+  void join()
+  {
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    if (writerThread_.joinable()) {
+      writerThread_.join();
+    }
+    if (writer_) {
+      writer_->close();
+      writer_.reset();
+    }
+  }
+
+  void runLoop(const std::int64_t numBlocks)
+  {
+    stats_.realtimePriority =
+      options_.realtimePriority && setCurrentThreadRealtimePriority(options_.priority);
+    if (options_.core >= 0) {
+      pinCurrentThreadToCore(options_.core);
+    }
+
+    const auto period = options_.blockSize / options_.sampleRate;
+    NullDevice device(period);
+    device.start();
+
+    for (std::int64_t block = 0;
+         running_.load(std::memory_order_relaxed) && block != numBlocks; ++block) {
+      const auto jitter = device.wait();
+      const auto start = std::chrono::steady_clock::now();
+
+      // The output is processed into a free block if there's one waiting to be written
+      T* outputBlock = nullptr;
+      const auto writing = writer_ && freeBlocks_.pop(outputBlock);
+      {
+        const detail::RealtimeScope scope{nodeName()};
+        processor_.process(input_.data(), writing ? outputBlock : output_.data(),
+                           options_.blockSize);
+      }
+      if (writing) {
+        filledBlocks_.push(outputBlock);
+      } else if (writer_) {
+        ++stats_.numDroppedBlocks;
+      }
+
+      const auto duration =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      // The deadline is the start of the next period
+      const auto xrun = device.timeUntilNextPeriod() < 0.0;
+      if (xrun) {
+        device.resynchronize();
+      }
+
+      record(duration, jitter, xrun, period);
+    }
+
+    processing_.store(false, std::memory_order_release);
+  }
+
+  // Writes the filled output blocks to the WAV file once per period, until the engine
+  // has stopped and the last blocks have been written
+  void runWriter()
+  {
+    const auto period =
+      std::chrono::duration<double>(options_.blockSize / options_.sampleRate);
+    for (;;) {
+      const auto finished = !processing_.load(std::memory_order_acquire);
+
+      T* block;
+      while (filledBlocks_.pop(block)) {
+        const T* channels[] = {block};
+        writer_->write(channels, options_.blockSize);
+        freeBlocks_.push(block);
+      }
+
+      if (finished) {
+        return;
+      }
+      std::this_thread::sleep_for(period);
+    }
+  }
+
+  void record(const double duration, const double jitter, const bool xrun, const double period)
+  {
+    ++stats_.numCallbacks;
+    stats_.numXruns += xrun ? 1 : 0;
+    stats_.maxJitter = std::max(stats_.maxJitter, jitter);
+    stats_.maxCallbackTime = std::max(stats_.maxCallbackTime, duration);
+    stats_.totalCallbackTime += duration;
+
+    const auto bin = std::min(int(duration / period / RealtimeStats::histogramBinWidth),
+                              RealtimeStats::numHistogramBins - 1);
+    ++stats_.histogram[bin];
+  }
+
+  Processor& processor_;
+  Options options_;
+  std::vector<T> input_;
+  std::vector<T> output_;
+  std::vector<std::vector<T>> outputBlocks_;
+  SpscQueue<T*> freeBlocks_;
+  SpscQueue<T*> filledBlocks_;
+  std::unique_ptr<io::WavFileWriter> writer_;
+  std::thread thread_;
+  std::thread writerThread_;
+  std::atomic<bool> running_{false};
+  // Cleared by the engine's thread once it has pushed its last block
+  std::atomic<bool> processing_{false};
+  RealtimeStats stats_;
+};
+
+} // chains
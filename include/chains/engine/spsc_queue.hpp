@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace chains {
+
+// A bounded lock-free queue with a single producer thread and a single consumer thread
+template <class Item>
+class SpscQueue
+{
+public:
+  // capacity is rounded up to a power of two
+  explicit SpscQueue(std::size_t capacity = 1)
+  {
+    auto size = std::size_t(1);
+    while (size < capacity) {
+      size *= 2;
+    }
+    items_.resize(size);
+    mask_ = size - 1;
+  }
+
+  // Returns false if the queue is full
+  bool push(const Item& item)
+  {
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_) {
+      return false;
+    }
+    items_[tail & mask_] = item;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Returns false if the queue is empty
+  bool pop(Item& item)
+  {
+    const auto head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = items_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Empties the queue, only safe while neither the producer nor the consumer is running
+  void clear() { head_.store(tail_.load()); }
+
+private:
+  std::vector<Item> items_;
+  std::size_t mask_;
+  // The producer's and consumer's positions are kept on separate cache lines
+  alignas(64) std::atomic<std::size_t> head_{0};
+  alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+} // chains
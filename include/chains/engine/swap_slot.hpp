@@ -0,0 +1,186 @@
+#pragma once
+
+#include "chains/dsp/fade_curves.hpp"
+#include "chains/engine/spsc_queue.hpp"
+#include "chains/realtime_check.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace chains {
+
+// Holds the processor that's running on the audio thread, and replaces it with new
+// processors without blocking the audio thread.
+//
+// A background thread makes a new processor, e.g. a DynamicChain loaded from a new
+// patch, and publishes it, which prepares it and hands it over with an atomic
+// exchange. The audio thread picks up the new processor at the start of its next
+// block, and crossfades from the old processor to the new one over fadeLength frames.
+// Once the fade is complete the old processor is passed back through a queue, to be
+// deleted by the background thread in publish or collect. The audio thread doesn't
+// allocate, free or lock.
+//
+// prepare must be called before publishing, so that new processors can be prepared
+// with the audio thread's settings. Publishing should be done from a single thread,
+// and processors that are published faster than the audio thread picks them up are
+// replaced without being run.
+template <class T, class Processor>
+class SwapSlot
+{
+public:
+  struct Options
+  {
+    int fadeLength = 1024;
+    dsp::FadeCurve curve = dsp::FadeCurve::EqualPower;
+    // The number of old processors that can wait to be deleted
+    std::size_t retiredCapacity = 8;
+  };
+
+  explicit SwapSlot(std::unique_ptr<Processor> processor, Options options = {})
+    : options_(options), current_(processor.release()), retired_(options.retiredCapacity)
+  {
+    assert(current_ != nullptr);
+    assert(options_.fadeLength > 0);
+  }
+
+  SwapSlot(const SwapSlot&) = delete;
+  SwapSlot& operator=(const SwapSlot&) = delete;
+
+  ~SwapSlot()
+  {
+    collect();
+    delete pending_.load();
+    delete unretired_;
+    delete next_;
+    delete current_;
+  }
+
+  // Prepares the current processor, and allocates the buffers used while fading.
+  // Called before processing starts, published processors are prepared with the same
+  // settings.
+  void prepare(const double sampleRate, const int maxBlockSize)
+  {
+    sampleRate_ = sampleRate;
+    maxBlockSize_ = maxBlockSize;
+    current_->prepare(sampleRate, maxBlockSize);
+    fadeOutput_.assign(maxBlockSize, T(0));
+    inputCopy_.assign(maxBlockSize, T(0));
+  }
+
+  // Prepares a processor and publishes it to the audio thread, and deletes any old
+  // processors. Called from the background thread, after prepare.
+  void publish(std::unique_ptr<Processor> processor)
+  {
+    assert(maxBlockSize_ > 0);
+    processor->prepare(sampleRate_, maxBlockSize_);
+    delete pending_.exchange(processor.release(), std::memory_order_acq_rel);
+    collect();
+  }
+
+  static const char* nodeName() { return "swap slot"; }
+
+  // Deletes the processors that the audio thread has finished with, returning how many
+  // were deleted. Called from the background thread.
+  int collect()
+  {
+    auto count = 0;
+    Processor* processor;
+    while (retired_.pop(processor)) {
+      delete processor;
+      ++count;
+    }
+    return count;
+  }
+
+  // Processes a block of samples with the current processor, crossfading to a newly
+  // published processor if there is one. in and out may point to the same buffer.
+  void process(const T* in, T* out, const int numFrames)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    assert(numFrames <= maxBlockSize_);
+
+    // A new processor isn't picked up until the last old one has been handed over
+    if (unretired_ && retired_.push(unretired_)) {
+      unretired_ = nullptr;
+    }
+    if (!next_ && !unretired_) {
+      next_ = pending_.exchange(nullptr, std::memory_order_acq_rel);
+      fadePosition_ = 0;
+    }
+
+    if (!next_) {
+      current_->process(in, out, numFrames);
+      return;
+    }
+
+    if (in == out) {
+      std::copy_n(in, numFrames, inputCopy_.data());
+      in = inputCopy_.data();
+    }
+
+    current_->process(in, fadeOutput_.data(), numFrames);
+    next_->process(in, out, numFrames);
+
+    switch (options_.curve) {
+    case dsp::FadeCurve::Linear: fade<dsp::FadeCurve::Linear>(out, numFrames); break;
+    case dsp::FadeCurve::EqualPower: fade<dsp::FadeCurve::EqualPower>(out, numFrames); break;
+    case dsp::FadeCurve::SCurve: fade<dsp::FadeCurve::SCurve>(out, numFrames); break;
+    case dsp::FadeCurve::Logarithmic:
+      fade<dsp::FadeCurve::Logarithmic>(out, numFrames);
+      break;
+    }
+
+    fadePosition_ += numFrames;
+    if (fadePosition_ >= options_.fadeLength) {
+      if (!retired_.push(current_)) {
+        unretired_ = current_;
+      }
+      current_ = next_;
+      next_ = nullptr;
+    }
+  }
+
+  // True while fading to a new processor, called from the audio thread
+  bool isFading() const { return next_ != nullptr; }
+
+  // The processor that's running, or that's being faded out. Only safe to use from the
+  // audio thread.
+  Processor& current() { return *current_; }
+
+private:
+  // Mixes the old processor's output into the new processor's output
+  template <dsp::FadeCurve Curve>
+  void fade(T* out, const int numFrames)
+  {
+    const auto step = T(1) / T(options_.fadeLength);
+    for (auto i = 0; i < numFrames; ++i) {
+      const auto x = std::min(T(fadePosition_ + i + 1) * step, T(1));
+      out[i] = fadeOutput_[i] * dsp::fadeGain<Curve>(T(1) - x)
+               + out[i] * dsp::fadeGain<Curve>(x);
+    }
+  }
+
+  Options options_;
+  double sampleRate_ = 0.0;
+  int maxBlockSize_ = 0;
+
+  // Owned by the audio thread
+  Processor* current_;
+  Processor* next_ = nullptr;
+  // An old processor that didn't fit in the retired queue
+  Processor* unretired_ = nullptr;
+  int fadePosition_ = 0;
+  std::vector<T> fadeOutput_;
+  std::vector<T> inputCopy_;
+
+  // Passed from the background thread to the audio thread
+  std::atomic<Processor*> pending_{nullptr};
+  // Passed from the audio thread to the background thread
+  SpscQueue<Processor*> retired_;
+};
+
+} // chains
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace chains {
+
+// Pins the calling thread to a core, wrapping around the number of cores.
+// Returns false if pinning isn't supported or was refused, e.g. in a restricted
+// cpuset, in which case the thread keeps running wherever it's scheduled.
+inline bool pinCurrentThreadToCore(const int core)
+{
+#ifdef __linux__
+  const auto numCores = int(std::max(1u, std::thread::hardware_concurrency()));
+  cpu_set_t cores;
+  CPU_ZERO(&cores);
+  CPU_SET(core % numCores, &cores);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores) == 0;
+#else
+  (void)core;
+  return false;
+#endif
+}
+
+// Switches the calling thread to SCHED_FIFO scheduling at the given priority.
+// Returns false if real-time scheduling isn't supported or isn't permitted, e.g.
+// without CAP_SYS_NICE or a suitable RLIMIT_RTPRIO.
+inline bool setCurrentThreadRealtimePriority(const int priority)
+{
+#ifdef __linux__
+  sched_param parameters{};
+  parameters.sched_priority = priority;
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &parameters) == 0;
+#else
+  (void)priority;
+  return false;
+#endif
+}
+
+} // chains
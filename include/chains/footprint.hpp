@@ -0,0 +1,135 @@
+#pragma once
+
+#include <boost/hana/map.hpp>
+#include <boost/hana/unpack.hpp>
+
+#include <cstddef>
+#include <initializer_list>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chains {
+
+// The memory used by a node in a processor tree, in bytes.
+//
+// Module processors keep the state that they use while processing at their start, in
+// the order it's used, followed by their inputs. Inputs without callbacks are read
+// while processing, so their values count as hot state, while the values of inputs
+// with callbacks are only read when they change. Callbacks are held out of line.
+//
+// The hot and cold sizes are known at compile time, see hotStateSize and
+// coldStateSize, and the heap size is known once the node has been prepared.
+struct Footprint
+{
+  // State that's read or written while processing
+  std::size_t hot = 0;
+  // Everything else held by the node, e.g. inputs with callbacks, names, and the
+  // bookkeeping for silence and scratch buffers
+  std::size_t cold = 0;
+  // Memory allocated by the node, e.g. delay lines, scratch buffers and callbacks.
+  // Memory that's shared between nodes, like FFT tables, isn't included.
+  std::size_t heap = 0;
+
+  std::size_t total() const { return hot + cold + heap; }
+};
+
+struct NodeFootprint
+{
+  // The node's depth in the tree, 0 for the root
+  int depth;
+  std::string name;
+  // Groups include the footprints of their processors
+  Footprint footprint;
+};
+
+using FootprintReport = std::vector<NodeFootprint>;
+
+namespace detail {
+
+constexpr std::size_t sumSizes(std::initializer_list<std::size_t> sizes)
+{
+  auto total = std::size_t(0);
+  for (const auto size : sizes) {
+    total += size;
+  }
+  return total;
+}
+
+struct SumInputsHotStateSize
+{
+  template <class... Inputs>
+  std::integral_constant<std::size_t, sumSizes({std::size_t(0), Inputs::hotStateSize...})>
+  operator()(const Inputs&...) const;
+};
+
+// The size of the values in a module's input map that are read while processing
+template <class Inputs>
+constexpr std::size_t inputsHotStateSize =
+  decltype(boost::hana::unpack(boost::hana::values(std::declval<const Inputs&>()),
+                               SumInputsHotStateSize{}))::value;
+
+template <class Node>
+void reportFootprint(Node& node, FootprintReport& report, int depth);
+
+template <class Node>
+Footprint nodeFootprint(const Node& node)
+{
+  return {Node::hotStateSize(), sizeof(Node) - Node::hotStateSize(), node.heapSize()};
+}
+
+template <class Node>
+void reportFootprint(Node& node, FootprintReport& report, const int depth)
+{
+  const std::string name = node.nodeName();
+  report.push_back({depth, name.empty() ? "module" : name, nodeFootprint(node)});
+  node.visitNodes([&report, depth](auto& child) { reportFootprint(child, report, depth + 1); });
+}
+
+} // detail
+
+template <class Node>
+constexpr std::size_t hotStateSize()
+{
+  return Node::hotStateSize();
+}
+
+template <class Node>
+constexpr std::size_t coldStateSize()
+{
+  return sizeof(Node) - Node::hotStateSize();
+}
+
+// The footprint of a processor tree, including all of its nodes
+template <class Node>
+Footprint footprint(const Node& node)
+{
+  return detail::nodeFootprint(node);
+}
+
+// The footprint of each node in a processor tree, in depth-first order. Modules are
+// listed by the names given to them in the chain's declaration.
+template <class Node>
+FootprintReport footprintReport(Node& node)
+{
+  FootprintReport report;
+  detail::reportFootprint(node, report, 0);
+  return report;
+}
+
+// Prints a report as a table, with nodes indented by their depth
+inline void printFootprintReport(const FootprintReport& report, std::ostream& out)
+{
+  out << std::left << std::setw(32) << "node" << std::right << std::setw(10) << "hot"
+      << std::setw(10) << "cold" << std::setw(10) << "heap" << '\n';
+  for (const auto& node : report) {
+    out << std::left << std::setw(32) << (std::string(node.depth * 2, ' ') + node.name)
+        << std::right << std::setw(10) << node.footprint.hot << std::setw(10)
+        << node.footprint.cold << std::setw(10) << node.footprint.heap << '\n';
+  }
+}
+
+} // chains
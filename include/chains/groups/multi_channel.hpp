@@ -0,0 +1,150 @@
+#pragma once
+
+#include "chains/bus.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+namespace chains {
+
+// Runs a copy of a single channel processor on each channel of a bus, e.g. to run a
+// mono chain on a stereo or surround signal.
+//
+// Planar buses are processed in place in the caller's buffers with each processor's
+// block process. Interleaved buses are processed in chunks, with each channel's chunk
+// copied into a buffer on the stack, processed in place with the processor's block
+// process, and copied back, so both layouts are processed in blocks.
+template <class Processor, int Channels>
+class MultiChannelProcessor
+{
+  std::array<Processor, Channels> processors_;
+
+  template <std::size_t... Channel>
+  static auto makeCopies(const Processor& prototype, std::index_sequence<Channel...>)
+  {
+    return std::array<Processor, Channels>{{(void(Channel), prototype)...}};
+  }
+
+public:
+  static constexpr int numChannels = Channels;
+
+  // The most frames of an interleaved bus that are copied for processing at a time
+  static constexpr int interleavedChunkSize = 128;
+
+  explicit MultiChannelProcessor(const Processor& prototype)
+    : processors_(makeCopies(prototype, std::make_index_sequence<Channels>{}))
+  {
+  }
+
+  Processor& operator[](int channel) { return processors_[channel]; }
+
+  void prepare(const double sampleRate, const int maxBlockSize)
+  {
+    for (auto& processor : processors_) {
+      processor.prepare(sampleRate, maxBlockSize);
+    }
+  }
+
+  void reset()
+  {
+    for (auto& processor : processors_) {
+      processor.reset();
+    }
+  }
+
+  template <class Visitor>
+  void visitState(Visitor& visitor)
+  {
+    for (auto& processor : processors_) {
+      processor.visitState(visitor);
+    }
+  }
+
+  int latency() const { return processors_[0].latency(); }
+
+  static const char* nodeName() { return "multi-channel"; }
+
+  static constexpr std::size_t hotStateSize()
+  {
+    return Channels * Processor::hotStateSize();
+  }
+
+  std::size_t heapSize() const
+  {
+    auto size = std::size_t(0);
+    for (const auto& processor : processors_) {
+      size += processor.heapSize();
+    }
+    return size;
+  }
+
+  template <class Visitor>
+  void visitNodes(Visitor&& visit)
+  {
+    for (auto& processor : processors_) {
+      visit(processor);
+    }
+  }
+
+  // Processes the input bus into the output bus, which may be the same buffers
+  template <class T>
+  void process(const Bus<const T, Channels>& in, const Bus<T, Channels>& out)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    assert(in.numFrames() == out.numFrames());
+    const auto numFrames = in.numFrames();
+
+    if (in.isPlanar() && out.isPlanar()) {
+      for (auto channel = 0; channel < Channels; ++channel) {
+        processors_[channel].process(in.channelPointers()[channel],
+                                     out.channelPointers()[channel], numFrames);
+      }
+      return;
+    }
+
+    // The chunks are no longer than the caller's block, which the processors need to
+    // have been prepared for
+    std::array<T, interleavedChunkSize> chunk;
+    for (auto start = 0; start < numFrames; start += interleavedChunkSize) {
+      const auto count = std::min(interleavedChunkSize, numFrames - start);
+      for (auto channel = 0; channel < Channels; ++channel) {
+        const auto input = in[channel];
+        for (auto i = 0; i < count; ++i) {
+          chunk[i] = input[start + i];
+        }
+
+        processors_[channel].process(chunk.data(), chunk.data(), count);
+
+        const auto output = out[channel];
+        for (auto i = 0; i < count; ++i) {
+          output[start + i] = chunk[i];
+        }
+      }
+    }
+  }
+
+  template <class T>
+  void process(const Bus<T, Channels>& in, const Bus<T, Channels>& out)
+  {
+    process(Bus<const T, Channels>{in}, out);
+  }
+
+  // Processes a bus in place
+  template <class T>
+  void process(const Bus<T, Channels>& bus)
+  {
+    process(Bus<const T, Channels>{bus}, bus);
+  }
+};
+
+// Makes a processor that runs a copy of prototype on each of a bus's channels
+template <int Channels, class Processor>
+auto multiChannel(const Processor& prototype)
+{
+  return MultiChannelProcessor<Processor, Channels>{prototype};
+}
+
+} // chains
@@ -5,19 +5,80 @@
 
 #include <boost/hana/fold.hpp>
 
+#include <algorithm>
+
 namespace chains {
 
+// In block mode, the processors' outputs are summed into an accumulator buffer,
+// with a second buffer for the output of each processor after the first
 template <class T, class Processors>
-struct ParallelProcessor : ProcessorGroup<Processors>
+struct ParallelProcessor : ProcessorGroup<T, Processors, 2>
 {
-  using ProcessorGroup<Processors>::ProcessorGroup;
+  using ProcessorGroup<T, Processors, 2>::ProcessorGroup;
 
   auto tick(const T& in = T(0))
   {
+    const detail::RealtimeScope scope{nodeName()};
     return boost::hana::fold(
       this->processors_, T(0),
       [&in](const T& result, auto& processor) { return result + processor.tick(in); });
   }
+
+  // The latency of the slowest processor, the processors aren't aligned with each other
+  int latency() const
+  {
+    return boost::hana::fold(this->processors_, 0, [](int latency, const auto& processor) {
+      return std::max(latency, processor.latency());
+    });
+  }
+
+  static const char* nodeName() { return "parallel"; }
+
+  // Processes a block of samples, in and out may point to the same buffer
+  void process(const T* in, T* out, int numFrames) { process(in, out, numFrames, false); }
+
+  // Processes a block of samples, leaving silent branches out of the sum.
+  // Returns true if all branches are silent.
+  bool process(const T* in, T* out, int numFrames, bool inputIsSilent)
+  {
+    return process(in, out, numFrames, inputIsSilent, this->scratch(numFrames));
+  }
+
+  bool process(const T* in,
+               T* out,
+               int numFrames,
+               bool inputIsSilent,
+               const ScratchBuffers<T>& scratch)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    // The input needs to stay intact until the last processor has run, so the sum
+    // only goes directly to the output when it isn't shared with the input
+    const auto sum = in == out ? scratch[0] : out;
+    const auto branch = scratch[1];
+    const auto processorScratch = this->processorScratch(scratch);
+
+    auto silent = true;
+    boost::hana::for_each(this->processors_, [&](auto& processor) {
+      const auto target = silent ? sum : branch;
+      if (!this->processNested(
+            processor, in, target, numFrames, inputIsSilent, processorScratch)) {
+        if (!silent) {
+          for (auto i = 0; i < numFrames; ++i) {
+            sum[i] += branch[i];
+          }
+        }
+        silent = false;
+      }
+    });
+
+    if (silent) {
+      std::fill_n(out, numFrames, T(0));
+    } else if (sum != out) {
+      std::copy_n(sum, numFrames, out);
+    }
+
+    return silent;
+  }
 };
 
 template <class... Modules>
@@ -0,0 +1,416 @@
+#pragma once
+
+#include "chains/engine/spsc_queue.hpp"
+#include "chains/engine/thread.hpp"
+#include "chains/groups/serial.hpp"
+
+#include <boost/hana/for_each.hpp>
+#include <boost/hana/length.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace chains {
+
+// Runs a serial chain's processors as a pipeline of stages on separate threads.
+//
+// When prepared, the cost of each processor is measured, and the chain is cut into
+// numStages stages of roughly equal cost. The first stage runs on the calling thread,
+// and each of the others runs on its own worker thread, with blocks handed from stage
+// to stage through lock-free queues. Each stage works on a different block, so a
+// block's output is available numStages - 1 calls after its input, which is included
+// in the reported latency.
+//
+// The pipeline needs to be prepared before processing, and then processes blocks of
+// the size it was prepared with. Preparing the pipeline starts and stops its worker
+// threads, so it shouldn't be called from a real-time thread. Resetting parks the
+// workers while the processors and the blocks in flight are cleared, without
+// allocating, and does nothing until the pipeline has been prepared.
+template <class T, class Processors>
+class SerialPipeline : public SerialProcessor<T, Processors>
+{
+  using Serial = SerialProcessor<T, Processors>;
+
+  static constexpr int numProcessors =
+    decltype(boost::hana::length(std::declval<Processors>()))::value;
+
+public:
+  SerialPipeline(const Serial& serial, const int numStages, const bool pinStages = true)
+    : Serial(serial)
+    , numStages_(std::max(1, std::min(numStages, numProcessors)))
+    , pinStages_(pinStages)
+  {
+    static_assert(allMonoProcessors<T, Processors>,
+                  "Pipelined processors need to exchange single channel blocks");
+  }
+
+  SerialPipeline(const SerialPipeline&) = delete;
+  SerialPipeline& operator=(const SerialPipeline&) = delete;
+
+  ~SerialPipeline() { stopWorkers(); }
+
+  // Pipelines only process blocks
+  T tick(const T&) = delete;
+
+  void prepare(const double sampleRate, const int blockSize)
+  {
+    stopWorkers();
+
+    Serial::prepare(sampleRate, blockSize);
+    blockSize_ = blockSize;
+
+    stageScratch_.assign(numStages_,
+                         std::vector<T>(std::size_t(Serial::numScratchBuffers) * blockSize));
+
+    divideStages(measureCosts());
+
+    // Each stage holds at most one block, with one more being filled by the caller
+    const auto numBlocks = numStages_ + 1;
+    blocks_.assign(numBlocks, std::vector<T>(blockSize));
+    orderedBlocks_.assign(numBlocks, nullptr);
+    blockStages_.assign(numBlocks, 0);
+    queues_.clear();
+    for (auto stage = 0; stage < numStages_; ++stage) {
+      queues_.push_back(std::make_unique<SpscQueue<T*>>(numBlocks));
+    }
+
+    startWorkers();
+  }
+
+  void reset()
+  {
+    if (stageStarts_.empty()) {
+      return;
+    }
+
+    parkWorkers();
+    Serial::reset();
+    clearBlocks();
+    releaseWorkers();
+  }
+
+  void process(const T* in, T* out, int numFrames)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    assert(numFrames == blockSize_);
+
+    auto* block = freeBlocks_.back();
+    freeBlocks_.pop_back();
+    std::copy(in, in + numFrames, block);
+    processStage(0, block);
+
+    if (numStages_ == 1) {
+      std::copy(block, block + numFrames, out);
+      freeBlocks_.push_back(block);
+      return;
+    }
+
+    queues_[0]->push(block);
+
+    // The output is silent until the first block has made it through the pipeline
+    if (blocksInFlight_ < numStages_ - 1) {
+      ++blocksInFlight_;
+      std::fill_n(out, numFrames, T(0));
+      return;
+    }
+
+    auto& output = *queues_[numStages_ - 1];
+    while (!output.pop(block)) {
+      std::this_thread::yield();
+    }
+    std::copy(block, block + numFrames, out);
+    freeBlocks_.push_back(block);
+  }
+
+  bool process(const T* in, T* out, int numFrames, bool /* inputIsSilent */)
+  {
+    process(in, out, numFrames);
+    return false;
+  }
+
+  bool process(const T* in,
+               T* out,
+               int numFrames,
+               bool inputIsSilent,
+               const ScratchBuffers<T>&)
+  {
+    return process(in, out, numFrames, inputIsSilent);
+  }
+
+  // Visits the processors' state, the division of the stages, and the blocks in flight,
+  // oldest first. The workers are parked while visiting, so that a snapshot can be taken
+  // between blocks and restored into a pipeline made from the same chain.
+  template <class Visitor>
+  void visitState(Visitor& visitor)
+  {
+    if (stageStarts_.empty()) {
+      Serial::visitState(visitor);
+      return;
+    }
+
+    parkWorkers();
+
+    // The blocks in flight are gathered from the output queue back to the first stage's
+    // queue, followed by the blocks held by the caller
+    auto numInFlight = 0;
+    for (auto stage = numStages_ - 1; stage >= 0; --stage) {
+      T* block;
+      while (queues_[stage]->pop(block)) {
+        orderedBlocks_[numInFlight] = block;
+        blockStages_[numInFlight] = stage;
+        ++numInFlight;
+      }
+    }
+    std::copy(
+      freeBlocks_.begin(), freeBlocks_.end(), orderedBlocks_.begin() + numInFlight);
+
+    Serial::visitState(visitor);
+    visitor(stageStarts_.data(), stageStarts_.size());
+    visitor(&blocksInFlight_, 1);
+    visitor(&numInFlight, 1);
+    visitor(blockStages_.data(), blockStages_.size());
+    for (auto* block : orderedBlocks_) {
+      visitor(block, std::size_t(blockSize_));
+    }
+
+    // The blocks are requeued in the order they were gathered, which may have been
+    // replaced by a restored snapshot
+    freeBlocks_.clear();
+    for (auto i = 0; i < int(orderedBlocks_.size()); ++i) {
+      if (i < numInFlight) {
+        queues_[blockStages_[i]]->push(orderedBlocks_[i]);
+      } else {
+        freeBlocks_.push_back(orderedBlocks_[i]);
+      }
+    }
+
+    releaseWorkers();
+  }
+
+  int latency() const { return Serial::latency() + (numStages_ - 1) * blockSize_; }
+
+  static const char* nodeName() { return "pipeline"; }
+
+  std::size_t heapSize() const
+  {
+    auto size = Serial::heapSize();
+    for (const auto& scratch : stageScratch_) {
+      size += scratch.capacity() * sizeof(T);
+    }
+    for (const auto& block : blocks_) {
+      size += block.capacity() * sizeof(T);
+    }
+    size += orderedBlocks_.capacity() * sizeof(T*);
+    size += blockStages_.capacity() * sizeof(int);
+    return size;
+  }
+
+  int numStages() const { return numStages_; }
+
+  // The index of the first processor in the stage
+  int stageStart(const int stage) const { return stageStarts_[stage]; }
+
+private:
+  // Runs the stage's processors on a block in place
+  void processStage(const int stage, T* block)
+  {
+    const auto start = stageStarts_[stage];
+    const auto end = stageStarts_[stage + 1];
+    const auto scratch = ScratchBuffers<T>{stageScratch_[stage].data(), blockSize_};
+
+    auto index = 0;
+    boost::hana::for_each(this->processors_, [&](auto& processor) {
+      if (index >= start && index < end) {
+        this->processNested(processor, block, block, blockSize_, false, scratch);
+      }
+      ++index;
+    });
+  }
+
+  // Returns the time taken by each processor to process a block of noise
+  std::vector<double> measureCosts()
+  {
+    const auto numBlocks = 8;
+
+    std::vector<T> block(blockSize_);
+    auto seed = 1u;
+    for (auto& sample : block) {
+      seed = seed * 1664525u + 1013904223u;
+      sample = T(double(seed >> 8) / double(1 << 24) - 0.5);
+    }
+
+    const auto scratch = ScratchBuffers<T>{stageScratch_[0].data(), blockSize_};
+    std::vector<T> work(blockSize_);
+    std::vector<double> costs;
+
+    boost::hana::for_each(this->processors_, [&](auto& processor) {
+      const auto start = std::chrono::steady_clock::now();
+      for (auto i = 0; i < numBlocks; ++i) {
+        std::copy(block.begin(), block.end(), work.begin());
+        this->processNested(processor, work.data(), work.data(), blockSize_, false,
+                            scratch);
+      }
+      costs.push_back(
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    });
+
+    Serial::reset();
+    return costs;
+  }
+
+  // Divides the processors into contiguous stages, minimizing the most costly stage
+  void divideStages(const std::vector<double>& costs)
+  {
+    const auto n = numProcessors;
+    std::vector<double> prefix(n + 1, 0.0);
+    for (auto i = 0; i < n; ++i) {
+      prefix[i + 1] = prefix[i] + costs[i];
+    }
+
+    // best[k][i] is the cost of the best division of the first i processors into k
+    // stages, with the start of the last stage in split[k][i]
+    const auto infinity = std::numeric_limits<double>::infinity();
+    std::vector<std::vector<double>> best(numStages_ + 1,
+                                          std::vector<double>(n + 1, infinity));
+    std::vector<std::vector<int>> split(numStages_ + 1, std::vector<int>(n + 1, 0));
+    best[0][0] = 0.0;
+
+    for (auto k = 1; k <= numStages_; ++k) {
+      for (auto i = k; i <= n; ++i) {
+        for (auto j = k - 1; j < i; ++j) {
+          const auto cost = std::max(best[k - 1][j], prefix[i] - prefix[j]);
+          if (cost < best[k][i]) {
+            best[k][i] = cost;
+            split[k][i] = j;
+          }
+        }
+      }
+    }
+
+    stageStarts_.assign(numStages_ + 1, n);
+    for (auto k = numStages_, i = n; k > 0; --k) {
+      i = split[k][i];
+      stageStarts_[k - 1] = i;
+    }
+  }
+
+  // Returns all of the blocks to the caller, only safe while the workers are stopped
+  // or parked
+  void clearBlocks()
+  {
+    freeBlocks_.clear();
+    for (auto& block : blocks_) {
+      freeBlocks_.push_back(block.data());
+    }
+    for (auto& queue : queues_) {
+      queue->clear();
+    }
+    blocksInFlight_ = 0;
+  }
+
+  void startWorkers()
+  {
+    clearBlocks();
+
+    running_ = true;
+    for (auto stage = 1; stage < numStages_; ++stage) {
+      workers_.emplace_back([this, stage] { runStage(stage); });
+    }
+  }
+
+  void stopWorkers()
+  {
+    running_ = false;
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+    workers_.clear();
+  }
+
+  // Waits for the workers to finish the blocks they're processing and then to wait
+  // until they're released
+  void parkWorkers()
+  {
+    parking_.store(true, std::memory_order_release);
+    while (numParked_.load(std::memory_order_acquire) < int(workers_.size())) {
+      std::this_thread::yield();
+    }
+  }
+
+  void releaseWorkers()
+  {
+    parking_.store(false, std::memory_order_release);
+    while (numParked_.load(std::memory_order_acquire) > 0) {
+      std::this_thread::yield();
+    }
+  }
+
+  void runStage(const int stage)
+  {
+    if (pinStages_) {
+      pinCurrentThreadToCore(stage);
+    }
+
+    auto& input = *queues_[stage - 1];
+    auto& output = *queues_[stage];
+
+    T* block;
+    while (running_.load(std::memory_order_relaxed)) {
+      if (parking_.load(std::memory_order_acquire)) {
+        numParked_.fetch_add(1, std::memory_order_acq_rel);
+        while (parking_.load(std::memory_order_acquire)) {
+          std::this_thread::yield();
+        }
+        numParked_.fetch_sub(1, std::memory_order_acq_rel);
+        continue;
+      }
+
+      if (!input.pop(block)) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      {
+        const detail::RealtimeScope scope{nodeName()};
+        processStage(stage, block);
+      }
+      output.push(block);
+    }
+  }
+
+  int numStages_;
+  bool pinStages_;
+  int blockSize_ = 0;
+  int blocksInFlight_ = 0;
+  std::vector<int> stageStarts_;
+  std::vector<std::vector<T>> stageScratch_;
+  std::vector<std::vector<T>> blocks_;
+  std::vector<T*> freeBlocks_;
+  // Used while visiting state, the blocks in flight followed by the free blocks, and the
+  // queue that each block in flight was waiting in
+  std::vector<T*> orderedBlocks_;
+  std::vector<int> blockStages_;
+  std::vector<std::unique_ptr<SpscQueue<T*>>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<bool> running_{false};
+  std::atomic<bool> parking_{false};
+  std::atomic<int> numParked_{0};
+};
+
+// Makes a pipeline of up to numStages stages from a serial chain's processor
+template <class T, class Processors>
+auto pipelined(const SerialProcessor<T, Processors>& serial,
+               const int numStages,
+               const bool pinStages = true)
+{
+  return SerialPipeline<T, Processors>{serial, numStages, pinStages};
+}
+
+} // chains
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "chains/dsp/fastmath.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chains {
+
+namespace detail {
+
+// A plain loop, so that the conversion is vectorized by the compiler
+template <class From, class To>
+void convertBlock(const From* in, To* out, const int numFrames)
+{
+  for (auto i = 0; i < numFrames; ++i) {
+    out[i] = To(in[i]);
+  }
+}
+
+} // detail
+
+// Runs an inner processor with sample type U in a chain with sample type T.
+//
+// Blocks are converted to U in a buffer owned by the processor, processed in place by
+// the inner processor, and converted back, so the conversions are done once per block
+// at each boundary between sample types. The inner processor is the root of its own
+// processor tree, with its own scratch buffers.
+template <class T, class U, class InnerProcessor>
+class PrecisionProcessor
+{
+public:
+  explicit PrecisionProcessor(InnerProcessor inner) : inner_(std::move(inner)) {}
+
+  auto tick(const T& in = T(0))
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    return T(inner_.tick(U(in)));
+  }
+
+  void process(const T* in, T* out, int numFrames) { process(in, out, numFrames, false); }
+
+  bool process(const T* in, T* out, int numFrames, bool inputIsSilent)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    detail::convertBlock(in, buffer_.data(), numFrames);
+    if (inner_.process(buffer_.data(), buffer_.data(), numFrames, inputIsSilent)) {
+      std::fill_n(out, numFrames, T(0));
+      return true;
+    }
+    detail::convertBlock(buffer_.data(), out, numFrames);
+    return false;
+  }
+
+  void init() { inner_.init(); }
+
+  void prepare(const double sampleRate, const int maxBlockSize)
+  {
+    inner_.prepare(sampleRate, maxBlockSize);
+    buffer_.assign(maxBlockSize, U(0));
+  }
+
+  void reset() { inner_.reset(); }
+
+  template <class Visitor>
+  void visitState(Visitor& visitor)
+  {
+    inner_.visitState(visitor);
+  }
+
+  int latency() const { return inner_.latency(); }
+
+  auto exposedInputs() { return inner_.exposedInputs(); }
+
+  static const char* nodeName() { return "precision"; }
+
+  static constexpr std::size_t hotStateSize() { return InnerProcessor::hotStateSize(); }
+
+  std::size_t heapSize() const
+  {
+    return buffer_.capacity() * sizeof(U) + inner_.heapSize();
+  }
+
+  template <class Visitor>
+  void visitNodes(Visitor&& visit)
+  {
+    visit(inner_);
+  }
+
+private:
+  InnerProcessor inner_;
+  std::vector<U> buffer_;
+};
+
+template <class U, class Module>
+class PrecisionModule
+{
+  Module module_;
+
+public:
+  explicit PrecisionModule(Module module) : module_(std::move(module)) {}
+
+  auto named(const char* name) const
+  {
+    return PrecisionModule{module_.named(name)};
+  }
+
+  template <class T, class Math = dsp::fastmath::Default>
+  auto makeProcessor(const double sampleRate) const
+  {
+    auto inner = module_.template makeProcessor<U, Math>(sampleRate);
+    return PrecisionProcessor<T, U, decltype(inner)>{std::move(inner)};
+  }
+
+  auto exposedParameters() const { return module_.exposedParameters(); }
+};
+
+// Overrides the sample type of a module or group, e.g. to run a feedback filter in
+// double precision in a chain that's otherwise processed in float:
+//
+//   serial(module<Gain>(), precision<double>(module<Biquad>()), module<Gain>())
+//     .makeProcessor<float>(sampleRate)
+template <class U, class Module>
+auto precision(Module&& module)
+{
+  return PrecisionModule<U, std::decay_t<Module>>(module);
+}
+
+} // chains
@@ -6,18 +6,72 @@
 namespace chains {
 
 template <class T, class Processors>
-struct RecursiveProcessor : ProcessorGroup<Processors>
+struct RecursiveProcessor : ProcessorGroup<T, Processors>
 {
-  using ProcessorGroup<Processors>::ProcessorGroup;
+  using ProcessorGroup<T, Processors>::ProcessorGroup;
 
   auto tick(const T& in = T(0))
   {
+    const detail::RealtimeScope scope{nodeName()};
     using namespace boost::hana::literals;
     const auto forward = this->processors_[0_c].tick(in + previous_);
     previous_ = this->processors_[1_c].tick(forward);
     return forward;
   }
 
+  // The feedback path has a single sample delay, so blocks are processed per sample
+  void process(const T* in, T* out, int numFrames)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    for (auto i = 0; i < numFrames; ++i) {
+      out[i] = tick(in[i]);
+    }
+  }
+
+  // The feedback loop's tail is unknown, so silent input is processed as usual
+  bool process(const T* in, T* out, int numFrames, bool /* inputIsSilent */)
+  {
+    process(in, out, numFrames);
+    return false;
+  }
+
+  bool process(const T* in,
+               T* out,
+               int numFrames,
+               bool inputIsSilent,
+               const ScratchBuffers<T>&)
+  {
+    return process(in, out, numFrames, inputIsSilent);
+  }
+
+  // Only the forward processor's latency delays the output
+  int latency() const
+  {
+    using namespace boost::hana::literals;
+    return this->processors_[0_c].latency();
+  }
+
+  void reset()
+  {
+    ProcessorGroup<T, Processors>::reset();
+    previous_ = T(0);
+  }
+
+  template <class Visitor>
+  void visitState(Visitor& visitor)
+  {
+    ProcessorGroup<T, Processors>::visitState(visitor);
+    visitor(&previous_, 1);
+  }
+
+  static const char* nodeName() { return "recursive"; }
+
+  // The fed back sample is read on every tick
+  static constexpr std::size_t hotStateSize()
+  {
+    return ProcessorGroup<T, Processors>::hotStateSize() + sizeof(T);
+  }
+
 private:
   T previous_ = T(0);
 };
@@ -1,23 +1,262 @@
 #pragma once
 
+#include "chains/bus.hpp"
 #include "chains/module_group.hpp"
 #include "chains/processor_group.hpp"
 
+#include <boost/hana/fold.hpp>
+#include <boost/hana/fold_left.hpp>
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
 namespace chains {
 
+namespace detail {
+
+// The width of the signal that a processor outputs in a serial chain, given the width of
+// its input: 0 for a mono signal, the number of channels for a planar signal that's
+// been fanned out by a split, or -1 if the processor can't take its input as a block.
+template <class T, class Processor, int Width, class = void>
+struct SerialOutputWidth : std::integral_constant<int, -1>
+{
+};
+
+template <class T, class Processor>
+struct SerialOutputWidth<T, Processor, 0, std::enable_if_t<isMonoProcessor<Processor, T>>>
+  : std::integral_constant<int, 0>
+{
+};
+
+template <class T, class Processor>
+struct SerialOutputWidth<T, Processor, 0, std::void_t<decltype(Processor::numOutputs)>>
+  : std::integral_constant<int, int(Processor::numOutputs)>
+{
+};
+
+// Processors that mix a planar signal down to mono
+template <class T, class Processor, int Width>
+struct SerialOutputWidth<
+  T,
+  Processor,
+  Width,
+  std::enable_if_t<(Width > 0) && canApply<CheckForPlanarTick,
+                                           Processor,
+                                           T,
+                                           std::integral_constant<int, Width>>::value>>
+  : std::integral_constant<int, 0>
+{
+};
+
+template <class T, int Width, class... Processors>
+struct IsBlockChain;
+
+template <class T, int Width>
+struct IsBlockChain<T, Width> : std::integral_constant<bool, Width == 0>
+{
+};
+
+template <class T, class Processor, class... Processors>
+struct IsBlockChain<T, -1, Processor, Processors...> : std::false_type
+{
+};
+
+template <class T, int Width, class Processor, class... Processors>
+struct IsBlockChain<T, Width, Processor, Processors...>
+  : IsBlockChain<T, SerialOutputWidth<T, Processor, Width>::value, Processors...>
+{
+};
+
 template <class T, class Processors>
-struct SerialProcessor : ProcessorGroup<Processors>
+struct IsSerialBlockChain;
+
+template <class T, class... Processors>
+struct IsSerialBlockChain<T, boost::hana::tuple<Processors...>>
+  : IsBlockChain<T, 0, Processors...>
+{
+};
+
+// The scratch buffers needed for the channels of the widest split in a serial chain
+template <class Processor, class = void>
+struct FanOutWidth : std::integral_constant<int, 0>
 {
-  using ProcessorGroup<Processors>::ProcessorGroup;
+};
+
+template <class Processor>
+struct FanOutWidth<Processor, std::void_t<decltype(Processor::numOutputs)>>
+  : std::integral_constant<int, int(Processor::numOutputs)>
+{
+};
+
+template <class Processors>
+struct MaxFanOutWidth;
+
+template <class... Processors>
+struct MaxFanOutWidth<boost::hana::tuple<Processors...>>
+  : std::integral_constant<int, std::max({0, FanOutWidth<Processors>::value...})>
+{
+};
+
+} // detail
+
+// Processes its processors one after the other.
+//
+// Block processing passes a mono signal from processor to processor in the output
+// buffer. A split in the chain fans the signal out into planar channels in the group's
+// own scratch buffers, with each branch writing directly to its channel, and the next
+// processor (e.g. a crossfade) mixes the channels back down into the output buffer.
+// Chains that can't be processed as blocks are processed sample by sample.
+template <class T, class Processors>
+struct SerialProcessor
+  : ProcessorGroup<T, Processors, detail::MaxFanOutWidth<Processors>::value>
+{
+  using ProcessorGroup<T, Processors, detail::MaxFanOutWidth<Processors>::value>::
+    ProcessorGroup;
 
   auto tick(const T& in = T(0))
   {
+    const detail::RealtimeScope scope{nodeName()};
     return boost::hana::unpack(this->processors_, [&in](auto&... processors) {
       return tickHelper(in, processors...);
     });
   }
 
+  // Processes a block of samples, in and out may point to the same buffer
+  void process(const T* in, T* out, int numFrames) { process(in, out, numFrames, false); }
+
+  // Processes a block of samples, passing silence from each processor to the next.
+  // Returns true if the output is silent.
+  bool process(const T* in, T* out, int numFrames, bool inputIsSilent)
+  {
+    return process(in, out, numFrames, inputIsSilent, this->scratch(numFrames));
+  }
+
+  bool process(const T* in,
+               T* out,
+               int numFrames,
+               bool inputIsSilent,
+               const ScratchBuffers<T>& scratch)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    return processBlock(
+      in, out, numFrames, inputIsSilent, scratch,
+      detail::IsSerialBlockChain<T, Processors>{});
+  }
+
+  // The processors' latencies add up
+  int latency() const
+  {
+    return boost::hana::fold(this->processors_, 0, [](int latency, const auto& processor) {
+      return latency + processor.latency();
+    });
+  }
+
+  static const char* nodeName() { return "serial"; }
+
 private:
+  // A mono signal, in the output buffer after the first processor
+  struct MonoSignal
+  {
+    const T* data;
+    bool silent;
+  };
+
+  // A signal fanned out by a split, with a channel in each of the group's own scratch
+  // buffers
+  template <int Channels>
+  struct PlanarSignal
+  {
+    std::array<T*, Channels> channels;
+    bool silent;
+  };
+
+  // Each processor after the first runs in place on the output buffer, so the
+  // processors can all share the same scratch buffers
+  bool processBlock(const T* in,
+                    T* out,
+                    int numFrames,
+                    bool silent,
+                    const ScratchBuffers<T>& scratch,
+                    std::true_type)
+  {
+    const auto signal = boost::hana::fold_left(
+      this->processors_, MonoSignal{in, silent}, [&](const auto& signal, auto& processor) {
+        return processStage(signal, processor, out, numFrames, scratch);
+      });
+    return signal.silent;
+  }
+
+  template <class Processor>
+  static auto processStage(const MonoSignal& in,
+                           Processor& processor,
+                           T* out,
+                           int numFrames,
+                           const ScratchBuffers<T>& scratch)
+  {
+    return processStage(in, processor, out, numFrames, scratch,
+                        detail::SerialOutputWidth<T, Processor, 0>{});
+  }
+
+  template <class Processor>
+  static MonoSignal processStage(const MonoSignal& in,
+                                 Processor& processor,
+                                 T* out,
+                                 int numFrames,
+                                 const ScratchBuffers<T>& scratch,
+                                 std::integral_constant<int, 0>)
+  {
+    return {out, SerialProcessor::processNested(processor, in.data, out, numFrames, in.silent,
+                                                SerialProcessor::processorScratch(scratch))};
+  }
+
+  // The split's processors write directly to the planar channels
+  template <class Processor, int Channels>
+  static PlanarSignal<Channels> processStage(const MonoSignal& in,
+                                             Processor& processor,
+                                             T* /* out */,
+                                             int numFrames,
+                                             const ScratchBuffers<T>& scratch,
+                                             std::integral_constant<int, Channels>)
+  {
+    auto signal = PlanarSignal<Channels>{};
+    for (auto channel = 0; channel < Channels; ++channel) {
+      signal.channels[channel] = scratch[channel];
+    }
+    const auto silent =
+      processor.process(in.data, signal.channels, numFrames, in.silent,
+                        SerialProcessor::processorScratch(scratch));
+    signal.silent = std::all_of(silent.begin(), silent.end(), [](bool s) { return s; });
+    return signal;
+  }
+
+  // The planar channels are mixed down into the output buffer
+  template <int Channels, class Processor>
+  static MonoSignal processStage(const PlanarSignal<Channels>& in,
+                                 Processor& processor,
+                                 T* out,
+                                 int numFrames,
+                                 const ScratchBuffers<T>&)
+  {
+    processor.process(Bus<const T, Channels>{Bus<T, Channels>::planar(in.channels, numFrames)},
+                      out, numFrames);
+    return {out, false};
+  }
+
+  // Processors exchanging multi-channel signals are processed sample by sample
+  bool processBlock(const T* in,
+                    T* out,
+                    int numFrames,
+                    bool,
+                    const ScratchBuffers<T>&,
+                    std::false_type)
+  {
+    for (auto i = 0; i < numFrames; ++i) {
+      out[i] = tick(in[i]);
+    }
+    return false;
+  }
+
   template <class TIn, class TProcessor, class... TProcessors>
   static auto tickHelper(const TIn& in, TProcessor& processor, TProcessors&... rest)
   {
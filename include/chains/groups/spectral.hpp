@@ -0,0 +1,159 @@
+#pragma once
+
+#include "chains/dsp/fastmath.hpp"
+#include "chains/dsp/stft.hpp"
+
+#include <complex>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chains {
+
+// Runs a chain over the spectrum of its input.
+//
+// The input is split into overlapping windowed frames of fftSize frames, every hop
+// frames, and each frame's bins are passed to the inner processor as a block of
+// std::complex<T> values, in order from DC to Nyquist. The inner processor is prepared
+// at the frame rate, sampleRate / hop, with a maximum block size of the number of bins.
+//
+// The FFT and the window are shared with all other spectral processors of the same
+// size, see dsp/stft.hpp.
+template <class T, class InnerProcessor>
+class SpectralProcessor
+{
+public:
+  SpectralProcessor(const int fftSize,
+                    const int hop,
+                    InnerProcessor inner,
+                    const double sampleRate)
+    : stft_(fftSize, hop)
+    , inner_(std::move(inner))
+    , bins_(stft_.numBins())
+  {
+    inner_.prepare(sampleRate / hop, stft_.numBins());
+  }
+
+  auto tick(const T& in = T(0))
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    return stft_.tick(in, [this](T* re, T* im, const int numBins) {
+      for (auto i = 0; i < numBins; ++i) {
+        bins_[i] = {re[i], im[i]};
+      }
+
+      inner_.process(bins_.data(), bins_.data(), numBins);
+
+      for (auto i = 0; i < numBins; ++i) {
+        re[i] = bins_[i].real();
+        im[i] = bins_[i].imag();
+      }
+    });
+  }
+
+  void process(const T* in, T* out, int numFrames)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    for (auto i = 0; i < numFrames; ++i) {
+      out[i] = tick(in[i]);
+    }
+  }
+
+  // The inner processor may add to its bins, so silent input is processed as usual
+  bool process(const T* in, T* out, int numFrames, bool /* inputIsSilent */)
+  {
+    process(in, out, numFrames);
+    return false;
+  }
+
+  void init() { inner_.init(); }
+
+  void prepare(const double sampleRate, const int /* maxBlockSize */)
+  {
+    inner_.prepare(sampleRate / stft_.hop(), stft_.numBins());
+  }
+
+  void reset()
+  {
+    stft_.reset();
+    inner_.reset();
+  }
+
+  template <class Visitor>
+  void visitState(Visitor& visitor)
+  {
+    stft_.visitState(visitor);
+    inner_.visitState(visitor);
+  }
+
+  // The inner processor's latency is in frames of bins, so it doesn't delay the output
+  int latency() const { return stft_.latency(); }
+
+  auto exposedInputs() { return inner_.exposedInputs(); }
+
+  static const char* nodeName() { return "spectral"; }
+
+  static constexpr std::size_t hotStateSize()
+  {
+    return sizeof(dsp::Stft<T>) + InnerProcessor::hotStateSize();
+  }
+
+  std::size_t heapSize() const
+  {
+    return stft_.heapSize() + bins_.capacity() * sizeof(std::complex<T>)
+           + inner_.heapSize();
+  }
+
+  template <class Visitor>
+  void visitNodes(Visitor&& visit)
+  {
+    visit(inner_);
+  }
+
+private:
+  dsp::Stft<T> stft_;
+  InnerProcessor inner_;
+  std::vector<std::complex<T>> bins_;
+};
+
+template <class Module>
+class SpectralModule
+{
+  int fftSize_;
+  int hop_;
+  Module module_;
+
+public:
+  SpectralModule(const int fftSize, const int hop, Module module)
+    : fftSize_(fftSize)
+    , hop_(hop)
+    , module_(std::move(module))
+  {
+  }
+
+  auto named(const char* name) const
+  {
+    return SpectralModule{fftSize_, hop_, module_.named(name)};
+  }
+
+  template <class T, class Math = dsp::fastmath::Default>
+  auto makeProcessor(const double sampleRate) const
+  {
+    auto inner =
+      module_.template makeProcessor<std::complex<T>, Math>(sampleRate / hop_);
+    return SpectralProcessor<T, decltype(inner)>{fftSize_, hop_, std::move(inner),
+                                                 sampleRate};
+  }
+
+  auto exposedParameters() const { return module_.exposedParameters(); }
+};
+
+// fftSize must be a power of two, and a multiple of hop of at least two
+template <class Module>
+auto spectral(const int fftSize, const int hop, Module&& module)
+{
+  return SpectralModule<std::decay_t<Module>>(fftSize, hop, module);
+}
+
+} // chains
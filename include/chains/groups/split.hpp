@@ -1,26 +1,90 @@
 #pragma once
 
+#include "chains/bus.hpp"
 #include "chains/module_group.hpp"
 #include "chains/processor_group.hpp"
 
+#include <boost/hana/fold.hpp>
+#include <boost/hana/size.hpp>
 #include <boost/hana/unpack.hpp>
 
+#include <algorithm>
 #include <array>
 
 namespace chains {
 
 template <class T, class Processors>
-struct SplitProcessor : ProcessorGroup<Processors>
+struct SplitProcessor : ProcessorGroup<T, Processors>
 {
-  using ProcessorGroup<Processors>::ProcessorGroup;
+  using ProcessorGroup<T, Processors>::ProcessorGroup;
 
+  static constexpr auto numOutputs =
+    decltype(boost::hana::size(std::declval<Processors>()))::value;
+
+  // The processors are ticked in place, each of them receiving the same input
   auto tick(const T& in = T(0))
   {
-    return boost::hana::unpack(
-      this->processors_,
-      [&in](auto... processors) {
-        return std::array<T, sizeof...(processors)>{{processors.tick(in)...}};
-      });
+    const detail::RealtimeScope scope{nodeName()};
+    return boost::hana::unpack(this->processors_, [&in](auto&... processors) {
+      return std::array<T, sizeof...(processors)>{{processors.tick(in)...}};
+    });
+  }
+
+  // The latency of the slowest processor, the outputs aren't aligned with each other
+  int latency() const
+  {
+    return boost::hana::fold(this->processors_, 0, [](int latency, const auto& processor) {
+      return std::max(latency, processor.latency());
+    });
+  }
+
+  static const char* nodeName() { return "split"; }
+
+  // Processes a block of samples, writing each processor's output to its own buffer.
+  // Returns which of the outputs are silent.
+  auto process(const T* in,
+               const std::array<T*, numOutputs>& out,
+               int numFrames,
+               bool inputIsSilent = false)
+  {
+    return process(in, out, numFrames, inputIsSilent, this->scratch(numFrames));
+  }
+
+  // Processes a block of samples into a bus, with an output channel for each processor.
+  // Planar buses are written to directly by the processors, interleaved buses are
+  // written to frame by frame.
+  void process(const T* in, const Bus<T, numOutputs>& out, int numFrames)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    if (out.isPlanar()) {
+      process(in, out.channelPointers(), numFrames);
+      return;
+    }
+
+    for (auto i = 0; i < numFrames; ++i) {
+      const auto frame = tick(in[i]);
+      for (auto output = 0; output < int(numOutputs); ++output) {
+        out(output, i) = frame[output];
+      }
+    }
+  }
+
+  // Each processor writes directly to its output buffer, so no scratch is needed
+  auto process(const T* in,
+               const std::array<T*, numOutputs>& out,
+               int numFrames,
+               bool inputIsSilent,
+               const ScratchBuffers<T>& scratch)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    auto silent = std::array<bool, numOutputs>{};
+    auto output = 0;
+    boost::hana::for_each(this->processors_, [&](auto& processor) {
+      silent[output] =
+        this->processNested(processor, in, out[output], numFrames, inputIsSilent, scratch);
+      ++output;
+    });
+    return silent;
   }
 };
 
@@ -0,0 +1,588 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Reading and writing of audio files for offline rendering.
+//
+// Files are expected to be little-endian, which is the byte order of WAV files and
+// of the platforms the chains are rendered on.
+
+namespace chains {
+namespace io {
+
+enum class SampleFormat
+{
+  Int16,
+  Int24,
+  Int32,
+  Float32,
+  Float64
+};
+
+inline int bytesPerSample(const SampleFormat format)
+{
+  switch (format) {
+  case SampleFormat::Int16: return 2;
+  case SampleFormat::Int24: return 3;
+  case SampleFormat::Int32: return 4;
+  case SampleFormat::Float32: return 4;
+  case SampleFormat::Float64: return 8;
+  }
+  return 0;
+}
+
+struct AudioFormat
+{
+  SampleFormat sampleFormat = SampleFormat::Float32;
+  int numChannels = 1;
+  double sampleRate = 44100.0;
+};
+
+// A read-only memory mapping of a whole file
+class MappedFile
+{
+  const std::uint8_t* data_ = nullptr;
+  std::size_t size_ = 0;
+
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile() { close(); }
+
+  // Returns false if the file couldn't be mapped
+  bool open(const std::string& path)
+  {
+    close();
+
+    const auto file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+      return false;
+    }
+
+    struct stat info;
+    if (::fstat(file, &info) != 0 || info.st_size == 0) {
+      ::close(file);
+      return false;
+    }
+
+    auto* data = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (data == MAP_FAILED) {
+      return false;
+    }
+
+    // The file is read once from start to end, so the kernel can read ahead
+    ::madvise(data, info.st_size, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const std::uint8_t*>(data);
+    size_ = std::size_t(info.st_size);
+    return true;
+  }
+
+  void close()
+  {
+    if (data_ != nullptr) {
+      ::munmap(const_cast<std::uint8_t*>(data_), size_);
+      data_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+  const std::uint8_t* data() const { return data_; }
+  std::size_t size() const { return size_; }
+};
+
+namespace detail {
+
+template <class Int>
+Int readLittleEndian(const std::uint8_t* bytes)
+{
+  Int value;
+  std::memcpy(&value, bytes, sizeof(Int));
+  return value;
+}
+
+// Converts a single sample in the given format to T
+template <SampleFormat Format>
+struct SampleConverter;
+
+template <>
+struct SampleConverter<SampleFormat::Int16>
+{
+  template <class T>
+  static T convert(const std::uint8_t* bytes)
+  {
+    return T(readLittleEndian<std::int16_t>(bytes)) * T(1.0 / 32768.0);
+  }
+};
+
+template <>
+struct SampleConverter<SampleFormat::Int24>
+{
+  template <class T>
+  static T convert(const std::uint8_t* bytes)
+  {
+    // The sample is placed in the top 24 bits, and shifted back to sign-extend it
+    const auto value = std::int32_t(std::uint32_t(bytes[0]) << 8
+                                    | std::uint32_t(bytes[1]) << 16
+                                    | std::uint32_t(bytes[2]) << 24)
+                       >> 8;
+    return T(value) * T(1.0 / 8388608.0);
+  }
+};
+
+template <>
+struct SampleConverter<SampleFormat::Int32>
+{
+  template <class T>
+  static T convert(const std::uint8_t* bytes)
+  {
+    return T(readLittleEndian<std::int32_t>(bytes)) * T(1.0 / 2147483648.0);
+  }
+};
+
+template <>
+struct SampleConverter<SampleFormat::Float32>
+{
+  template <class T>
+  static T convert(const std::uint8_t* bytes)
+  {
+    return T(readLittleEndian<float>(bytes));
+  }
+};
+
+template <>
+struct SampleConverter<SampleFormat::Float64>
+{
+  template <class T>
+  static T convert(const std::uint8_t* bytes)
+  {
+    return T(readLittleEndian<double>(bytes));
+  }
+};
+
+template <SampleFormat Format, class T>
+void convertStrided(const std::uint8_t* in, const int stride, T* out, const int numFrames)
+{
+  for (auto i = 0; i < numFrames; ++i) {
+    out[i] = SampleConverter<Format>::template convert<T>(in + i * stride);
+  }
+}
+
+template <SampleFormat Format, class T>
+void convertInterleaved(const std::uint8_t* in,
+                        const int numChannels,
+                        T* const* out,
+                        const int numFrames)
+{
+  const auto sampleSize = bytesPerSample(Format);
+  for (auto i = 0; i < numFrames; ++i) {
+    for (auto channel = 0; channel < numChannels; ++channel) {
+      out[channel][i] = SampleConverter<Format>::template convert<T>(in);
+      in += sampleSize;
+    }
+  }
+}
+
+// Converts numFrames samples, stride bytes apart, to T.
+// Each format has its own loop, so that the loops are simple enough to vectorize.
+template <class T>
+void convertSamples(const std::uint8_t* in,
+                    const SampleFormat format,
+                    const int stride,
+                    T* out,
+                    const int numFrames)
+{
+  switch (format) {
+  case SampleFormat::Int16:
+    convertStrided<SampleFormat::Int16>(in, stride, out, numFrames);
+    break;
+  case SampleFormat::Int24:
+    convertStrided<SampleFormat::Int24>(in, stride, out, numFrames);
+    break;
+  case SampleFormat::Int32:
+    convertStrided<SampleFormat::Int32>(in, stride, out, numFrames);
+    break;
+  case SampleFormat::Float32:
+    convertStrided<SampleFormat::Float32>(in, stride, out, numFrames);
+    break;
+  case SampleFormat::Float64:
+    convertStrided<SampleFormat::Float64>(in, stride, out, numFrames);
+    break;
+  }
+}
+
+// Converts numFrames interleaved frames of numChannels samples to T, into a block per
+// channel. The frames are read in a single pass, in the order that they're stored.
+template <class T>
+void deinterleaveSamples(const std::uint8_t* in,
+                         const SampleFormat format,
+                         const int numChannels,
+                         T* const* out,
+                         const int numFrames)
+{
+  switch (format) {
+  case SampleFormat::Int16:
+    convertInterleaved<SampleFormat::Int16>(in, numChannels, out, numFrames);
+    break;
+  case SampleFormat::Int24:
+    convertInterleaved<SampleFormat::Int24>(in, numChannels, out, numFrames);
+    break;
+  case SampleFormat::Int32:
+    convertInterleaved<SampleFormat::Int32>(in, numChannels, out, numFrames);
+    break;
+  case SampleFormat::Float32:
+    convertInterleaved<SampleFormat::Float32>(in, numChannels, out, numFrames);
+    break;
+  case SampleFormat::Float64:
+    convertInterleaved<SampleFormat::Float64>(in, numChannels, out, numFrames);
+    break;
+  }
+}
+
+} // detail
+
+// Reads samples from a memory mapped WAV or raw PCM file
+class AudioFileReader
+{
+  MappedFile file_;
+  AudioFormat format_;
+  const std::uint8_t* samples_ = nullptr;
+  std::int64_t numFrames_ = 0;
+  std::string error_;
+
+public:
+  // Returns false if the file couldn't be opened or isn't a supported WAV file,
+  // with the reason available from error()
+  bool openWav(const std::string& path)
+  {
+    if (!file_.open(path)) {
+      return fail("Unable to open " + path);
+    }
+
+    const auto* data = file_.data();
+    const auto size = file_.size();
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0
+        || std::memcmp(data + 8, "WAVE", 4) != 0) {
+      return fail(path + " isn't a WAV file");
+    }
+
+    auto haveFormat = false;
+    for (std::size_t offset = 12; offset + 8 <= size;) {
+      const auto* chunk = data + offset;
+      const auto chunkSize = std::size_t(detail::readLittleEndian<std::uint32_t>(chunk + 4));
+      const auto* body = chunk + 8;
+      const auto available = std::min(chunkSize, size - offset - 8);
+
+      if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+        auto formatTag = detail::readLittleEndian<std::uint16_t>(body);
+        const auto bitsPerSample = detail::readLittleEndian<std::uint16_t>(body + 14);
+        // WAVE_FORMAT_EXTENSIBLE keeps the format tag in its sub-format GUID
+        if (formatTag == 0xFFFE && available >= 26) {
+          formatTag = detail::readLittleEndian<std::uint16_t>(body + 24);
+        }
+        if (!parseSampleFormat(formatTag, bitsPerSample)) {
+          return fail(path + " has an unsupported sample format");
+        }
+        format_.numChannels = detail::readLittleEndian<std::uint16_t>(body + 2);
+        format_.sampleRate = detail::readLittleEndian<std::uint32_t>(body + 4);
+        haveFormat = format_.numChannels > 0;
+      } else if (std::memcmp(chunk, "data", 4) == 0 && haveFormat) {
+        samples_ = body;
+        numFrames_ = available / frameSize();
+        return true;
+      }
+
+      // Chunks are padded to an even size
+      offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    return fail(path + " has no audio data");
+  }
+
+  // Opens a headerless file of interleaved samples.
+  // Returns false if the file couldn't be opened or the format isn't valid.
+  bool openRaw(const std::string& path, const AudioFormat& format)
+  {
+    if (format.numChannels <= 0) {
+      return fail("Raw input needs at least one channel");
+    }
+    if (bytesPerSample(format.sampleFormat) == 0) {
+      return fail("Raw input has an unsupported sample format");
+    }
+    if (!file_.open(path)) {
+      return fail("Unable to open " + path);
+    }
+
+    format_ = format;
+    samples_ = file_.data();
+    numFrames_ = file_.size() / frameSize();
+    return true;
+  }
+
+  const AudioFormat& format() const { return format_; }
+  std::int64_t numFrames() const { return numFrames_; }
+  const std::string& error() const { return error_; }
+
+  // Converts numFrames of a channel's samples, starting at startFrame, to T
+  template <class T>
+  void read(const int channel, const std::int64_t startFrame, const int numFrames, T* out)
+    const
+  {
+    const auto sampleSize = bytesPerSample(format_.sampleFormat);
+    const auto* in = samples_ + startFrame * frameSize() + channel * sampleSize;
+    detail::convertSamples(in, format_.sampleFormat, frameSize(), out, numFrames);
+  }
+
+  // Converts numFrames of every channel's samples, starting at startFrame, to T, with
+  // channels[channel] receiving the channel's samples
+  template <class T>
+  void read(const std::int64_t startFrame, const int numFrames, T* const* channels) const
+  {
+    const auto* in = samples_ + startFrame * frameSize();
+    detail::deinterleaveSamples(
+      in, format_.sampleFormat, format_.numChannels, channels, numFrames);
+  }
+
+private:
+  int frameSize() const { return bytesPerSample(format_.sampleFormat) * format_.numChannels; }
+
+  bool parseSampleFormat(const int formatTag, const int bitsPerSample)
+  {
+    const auto pcm = 1;
+    const auto ieeeFloat = 3;
+
+    if (formatTag == pcm && bitsPerSample == 16) {
+      format_.sampleFormat = SampleFormat::Int16;
+    } else if (formatTag == pcm && bitsPerSample == 24) {
+      format_.sampleFormat = SampleFormat::Int24;
+    } else if (formatTag == pcm && bitsPerSample == 32) {
+      format_.sampleFormat = SampleFormat::Int32;
+    } else if (formatTag == ieeeFloat && bitsPerSample == 32) {
+      format_.sampleFormat = SampleFormat::Float32;
+    } else if (formatTag == ieeeFloat && bitsPerSample == 64) {
+      format_.sampleFormat = SampleFormat::Float64;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  bool fail(std::string error)
+  {
+    file_.close();
+    samples_ = nullptr;
+    numFrames_ = 0;
+    error_ = std::move(error);
+    return false;
+  }
+};
+
+// Writes 32-bit float WAV files through a write-behind buffer.
+//
+// Samples are interleaved into one half of the buffer while the other half is being
+// written to disk by a background thread, so rendering only waits for the disk when
+// it's faster than the disk can keep up with.
+class WavFileWriter
+{
+  int file_ = -1;
+  int numChannels_ = 0;
+  double sampleRate_ = 0.0;
+  std::int64_t bytesWritten_ = 0;
+  std::vector<float> buffers_[2];
+  std::size_t filled_ = 0;
+  int current_ = 0;
+  bool writeFailed_ = false;
+
+  std::thread writer_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  // The number of samples in the buffer waiting to be written, 0 when the writer is idle
+  std::size_t pending_ = 0;
+  bool stopping_ = false;
+
+  static constexpr int headerSize = 44;
+
+public:
+  WavFileWriter() = default;
+  WavFileWriter(const WavFileWriter&) = delete;
+  WavFileWriter& operator=(const WavFileWriter&) = delete;
+  ~WavFileWriter() { close(); }
+
+  // Returns false if the file couldn't be created.
+  // bufferFrames is the size of each half of the write-behind buffer.
+  bool open(const std::string& path,
+            const int numChannels,
+            const double sampleRate,
+            const int bufferFrames = 1 << 18)
+  {
+    close();
+
+    file_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file_ < 0) {
+      return false;
+    }
+
+    numChannels_ = numChannels;
+    sampleRate_ = sampleRate;
+    bytesWritten_ = 0;
+    writeFailed_ = false;
+    for (auto& buffer : buffers_) {
+      buffer.assign(std::size_t(bufferFrames) * numChannels, 0.0f);
+    }
+    filled_ = 0;
+    current_ = 0;
+    pending_ = 0;
+    stopping_ = false;
+
+    // The header is rewritten with the data size when the file is closed
+    writeHeader();
+    writer_ = std::thread([this] { runWriter(); });
+    return true;
+  }
+
+  // Appends numFrames from each of the channels
+  template <class T>
+  void write(const T* const* channels, const int numFrames)
+  {
+    auto frame = 0;
+    while (frame < numFrames) {
+      auto& buffer = buffers_[current_];
+      const auto count =
+        std::min(numFrames - frame, int((buffer.size() - filled_) / numChannels_));
+
+      auto* out = buffer.data() + filled_;
+      for (auto channel = 0; channel < numChannels_; ++channel) {
+        const auto* in = channels[channel] + frame;
+        for (auto i = 0; i < count; ++i) {
+          out[i * numChannels_ + channel] = float(in[i]);
+        }
+      }
+
+      filled_ += std::size_t(count) * numChannels_;
+      frame += count;
+
+      if (filled_ == buffer.size()) {
+        flush();
+      }
+    }
+  }
+
+  // Writes any remaining samples and completes the file's header.
+  // Returns false if any of the file's data couldn't be written.
+  bool close()
+  {
+    if (file_ < 0) {
+      return false;
+    }
+
+    flush();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    condition_.notify_all();
+    writer_.join();
+
+    writeHeader();
+    ::close(file_);
+    file_ = -1;
+    return !writeFailed_;
+  }
+
+private:
+  // Hands the current buffer to the writer, once it has finished with the other one
+  void flush()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_.wait(lock, [this] { return pending_ == 0; });
+    if (filled_ > 0) {
+      pending_ = filled_;
+      current_ = 1 - current_;
+      filled_ = 0;
+      lock.unlock();
+      condition_.notify_all();
+    }
+  }
+
+  void runWriter()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+      condition_.wait(lock, [this] { return pending_ > 0 || stopping_; });
+      if (pending_ == 0) {
+        return;
+      }
+
+      // The buffer being written is the one that isn't being filled
+      const auto& buffer = buffers_[1 - current_];
+      const auto size = pending_ * sizeof(float);
+      lock.unlock();
+
+      writeBytes(buffer.data(), size);
+
+      lock.lock();
+      bytesWritten_ += std::int64_t(size);
+      pending_ = 0;
+      condition_.notify_all();
+    }
+  }
+
+  void writeBytes(const void* data, std::size_t size)
+  {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+      const auto written = ::write(file_, bytes, size);
+      if (written <= 0) {
+        writeFailed_ = true;
+        return;
+      }
+      bytes += written;
+      size -= std::size_t(written);
+    }
+  }
+
+  void writeHeader()
+  {
+    const auto dataSize = std::uint32_t(bytesWritten_);
+    const auto blockAlign = std::uint16_t(numChannels_ * sizeof(float));
+
+    std::uint8_t header[headerSize];
+    const auto put = [&header](int offset, auto value) {
+      std::memcpy(header + offset, &value, sizeof(value));
+    };
+    std::memcpy(header, "RIFF", 4);
+    put(4, std::uint32_t(headerSize - 8 + dataSize));
+    std::memcpy(header + 8, "WAVEfmt ", 8);
+    put(16, std::uint32_t(16));
+    put(20, std::uint16_t(3));
+    put(22, std::uint16_t(numChannels_));
+    put(24, std::uint32_t(sampleRate_));
+    put(28, std::uint32_t(sampleRate_ * blockAlign));
+    put(32, blockAlign);
+    put(34, std::uint16_t(32));
+    std::memcpy(header + 36, "data", 4);
+    put(40, dataSize);
+
+    if (::pwrite(file_, header, headerSize, 0) != headerSize) {
+      writeFailed_ = true;
+    }
+    ::lseek(file_, 0, SEEK_END);
+  }
+};
+
+} // io
+} // chains
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "chains/realtime_check.hpp"
+
+#include <boost/hana/for_each.hpp>
+#include <boost/hana/length.hpp>
+#include <boost/hana/tuple.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace chains {
+
+namespace modulation {
+
+// The shape applied to a source's value before it's scaled by a route's depth
+enum class Curve
+{
+  // The source's value as-is
+  Linear,
+  // Maps a bipolar source in [-1, 1] to [0, 1]
+  Unipolar,
+  // x * |x|, keeping the sign, for finer control near zero
+  Quadratic,
+  // x^3
+  Cubic
+};
+
+namespace detail {
+
+// out[i] += depth * curve(in[i]), each curve has its own loop so that it vectorizes
+template <class T>
+void multiplyAccumulate(const T* in, T* out, int count, T depth, Curve curve)
+{
+  switch (curve) {
+  case Curve::Linear:
+    for (auto i = 0; i < count; ++i) {
+      out[i] += depth * in[i];
+    }
+    break;
+  case Curve::Unipolar:
+    for (auto i = 0; i < count; ++i) {
+      out[i] += depth * (in[i] * T(0.5) + T(0.5));
+    }
+    break;
+  case Curve::Quadratic:
+    for (auto i = 0; i < count; ++i) {
+      out[i] += depth * in[i] * std::abs(in[i]);
+    }
+    break;
+  case Curve::Cubic:
+    for (auto i = 0; i < count; ++i) {
+      out[i] += depth * in[i] * in[i] * in[i];
+    }
+    break;
+  }
+}
+
+} // detail
+
+} // modulation
+
+// Modulates exposed inputs with the outputs of source processors.
+//
+// Routes connect a source to a target input, with a depth and a curve. Rather than
+// being applied per sample, modulation is evaluated at control rate: each block is
+// divided into sub-blocks of subBlockSize frames, the sources are sampled at the start
+// of each sub-block, and each route is accumulated into its target's offsets for the
+// block in a single pass. The modulated processor is then run sub-block by sub-block,
+// with each target set to its base value plus its offset in between.
+//
+// Targets are the inputs returned by exposedInputs, each target's base value is its
+// value when it's first routed to, and can be changed with setBaseValue.
+template <class T, class Sources>
+class ModulationMatrix
+{
+  static constexpr int numSources =
+    decltype(boost::hana::length(std::declval<Sources>()))::value;
+
+public:
+  ModulationMatrix(Sources sources, const int subBlockSize)
+    : sources_(std::move(sources)), subBlockSize_(subBlockSize)
+  {
+  }
+
+  // Adds a route from a source to a target, returning the route's index
+  template <class Input>
+  int addRoute(const int source,
+               Input* target,
+               const double depth,
+               const modulation::Curve curve = modulation::Curve::Linear)
+  {
+    assert(source >= 0 && source < numSources);
+    routes_.push_back({source, targetIndex(target), T(depth), curve});
+    return int(routes_.size()) - 1;
+  }
+
+  void setDepth(const int route, const double depth) { routes_[route].depth = T(depth); }
+
+  // Sets the value that the target's modulation is added to
+  template <class Input>
+  void setBaseValue(Input* target, const double value)
+  {
+    targets_[targetIndex(target)].base = value;
+  }
+
+  // Prepares the sources, and allocates the matrix's buffers for blocks of up to
+  // maxBlockSize frames. Routes to new targets can be added after preparing, but they
+  // allocate, so they shouldn't be added while processing.
+  void prepare(const double sampleRate, const int maxBlockSize)
+  {
+    boost::hana::for_each(sources_, [=](auto& source) {
+      source.prepare(sampleRate, maxBlockSize);
+    });
+
+    maxBlockSize_ = maxBlockSize;
+    maxSubBlocks_ = (maxBlockSize + subBlockSize_ - 1) / subBlockSize_;
+    sourceOutput_.assign(maxBlockSize, T(0));
+    controls_.assign(std::size_t(numSources) * maxSubBlocks_, T(0));
+    offsets_.assign(targets_.size() * maxSubBlocks_, T(0));
+  }
+
+  void reset()
+  {
+    boost::hana::for_each(sources_, [](auto& source) { source.reset(); });
+  }
+
+  // Processes a block with the processor, modulating its inputs every sub-block. The
+  // sources are given the same input as the processor.
+  template <class Processor>
+  void process(Processor& processor, const T* in, T* out, const int numFrames)
+  {
+    const detail::RealtimeScope scope{nodeName()};
+    assert(numFrames <= maxBlockSize_);
+
+    const auto numSubBlocks = (numFrames + subBlockSize_ - 1) / subBlockSize_;
+
+    // Sample each source at the start of each sub-block
+    auto sourceIndex = 0;
+    boost::hana::for_each(sources_, [&](auto& source) {
+      source.process(in, sourceOutput_.data(), numFrames);
+      auto* controls = &controls_[std::size_t(sourceIndex) * maxSubBlocks_];
+      for (auto i = 0; i < numSubBlocks; ++i) {
+        controls[i] = sourceOutput_[i * subBlockSize_];
+      }
+      ++sourceIndex;
+    });
+
+    // The routes are sparse, so each one is accumulated in its own pass
+    std::fill(offsets_.begin(), offsets_.end(), T(0));
+    for (const auto& route : routes_) {
+      modulation::detail::multiplyAccumulate(
+        &controls_[std::size_t(route.source) * maxSubBlocks_],
+        &offsets_[std::size_t(route.target) * maxSubBlocks_], numSubBlocks, route.depth,
+        route.curve);
+    }
+
+    for (auto subBlock = 0; subBlock < numSubBlocks; ++subBlock) {
+      for (auto target = 0; target < int(targets_.size()); ++target) {
+        auto& state = targets_[target];
+        state.setValue(state.input,
+                       state.base + double(offsets_[target * maxSubBlocks_ + subBlock]));
+      }
+
+      const auto start = subBlock * subBlockSize_;
+      processor.process(in + start, out + start, std::min(subBlockSize_, numFrames - start));
+    }
+  }
+
+  Sources& sources() { return sources_; }
+
+  static const char* nodeName() { return "modulation"; }
+
+private:
+  struct Route
+  {
+    int source;
+    int target;
+    T depth;
+    modulation::Curve curve;
+  };
+
+  struct Target
+  {
+    void* input;
+    // Calls the input's setValue, without needing to know the input's type
+    void (*setValue)(void* input, double value);
+    double base;
+  };
+
+  template <class Input>
+  int targetIndex(Input* input)
+  {
+    const auto existing =
+      std::find_if(targets_.begin(), targets_.end(),
+                   [input](const Target& target) { return target.input == input; });
+    if (existing != targets_.end()) {
+      return int(existing - targets_.begin());
+    }
+
+    targets_.push_back({input,
+                        [](void* target, double value) {
+                          static_cast<Input*>(target)->setValue(value);
+                        },
+                        input->value()});
+    // Make room for the new target's offsets if the matrix has been prepared
+    offsets_.resize(targets_.size() * maxSubBlocks_, T(0));
+    return int(targets_.size()) - 1;
+  }
+
+  Sources sources_;
+  int subBlockSize_;
+  int maxBlockSize_ = 0;
+  int maxSubBlocks_ = 0;
+  std::vector<Route> routes_;
+  std::vector<Target> targets_;
+  std::vector<T> sourceOutput_;
+  // The sources' values at the start of each sub-block
+  std::vector<T> controls_;
+  // The modulation for each target at each sub-block
+  std::vector<T> offsets_;
+};
+
+// Makes a modulation matrix for modulating processors of type T, with the given source
+// processors
+template <class T, class... Sources>
+auto modulationMatrix(const int subBlockSize, Sources... sources)
+{
+  using SourceTuple = boost::hana::tuple<Sources...>;
+  return ModulationMatrix<T, SourceTuple>{SourceTuple{std::move(sources)...}, subBlockSize};
+}
+
+} // chains
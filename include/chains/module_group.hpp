@@ -1,5 +1,7 @@
 #pragma once
 
+#include "chains/dsp/fastmath.hpp"
+
 #include <boost/hana/flatten.hpp>
 #include <boost/hana/transform.hpp>
 #include <boost/hana/tuple.hpp>
@@ -25,10 +27,12 @@ struct ModuleGroup
       modules_, [&name](const auto& module) { return module.named(name); })};
   }
 
-  template <class T>
+  // Math selects the accuracy of the math functions used by the chain's modules,
+  // see dsp/fastmath.hpp
+  template <class T, class Math = dsp::fastmath::Default>
   auto makeProcessor(const double sampleRate) const
   {
-    auto moduleProcessors = makeProcessors<T>(sampleRate);
+    auto moduleProcessors = makeProcessors<T, Math>(sampleRate);
     return ProcessorGroup<T, decltype(moduleProcessors)>{moduleProcessors};
   }
 
@@ -39,11 +43,11 @@ struct ModuleGroup
   }
 
 protected:
-  template <class T>
+  template <class T, class Math>
   auto makeProcessors(const double sampleRate) const
   {
     return boost::hana::transform(modules_, [=](const auto& module) {
-      return module.template makeProcessor<T>(sampleRate);
+      return module.template makeProcessor<T, Math>(sampleRate);
     });
   }
 
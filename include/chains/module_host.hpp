@@ -1,5 +1,6 @@
 #pragma once
 
+#include "chains/dsp/fastmath.hpp"
 #include "chains/parameter.hpp"
 #include "chains/processor_host.hpp"
 
@@ -7,8 +8,52 @@
 #include <boost/hana/map.hpp>
 #include <boost/hana/tuple.hpp>
 
+#include <cstdlib>
+#include <string>
+#include <typeinfo>
+
+#include <cxxabi.h>
+
 namespace chains {
 
+namespace detail {
+
+// Modules that don't use math functions have Processors with two template parameters
+template <class Traits, class T, class Inputs, class Math, class = void>
+struct ModuleProcessor
+{
+  using type = typename Traits::template Processor<T, Inputs>;
+};
+
+// Modules that use math functions take the chain's accuracy as a third parameter
+template <class Traits, class T, class Inputs, class Math>
+struct ModuleProcessor<Traits,
+                       T,
+                       Inputs,
+                       Math,
+                       std::void_t<typename Traits::template Processor<T, Inputs, Math>>>
+{
+  using type = typename Traits::template Processor<T, Inputs, Math>;
+};
+
+// The name of a module's traits type, e.g. "chains::gain::Module", which identifies
+// unnamed modules in reports. It's demangled once, when the first processor is made.
+template <class Traits>
+const char* moduleTypeName()
+{
+  static const auto name = [] {
+    const auto* mangled = typeid(Traits).name();
+    auto status = 0;
+    auto* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    const auto result = std::string{status == 0 ? demangled : mangled};
+    std::free(demangled);
+    return result;
+  }();
+  return name.c_str();
+}
+
+} // detail
+
 template <class Traits, class Parameters, class Exposed>
 class ModuleHost;
 
@@ -18,6 +63,7 @@ class ModuleHost<Traits, Parameters, Expose<Exposed...>>
 {
   const boost::hana::tuple<Parameter<Exposed>...> exposed_;
   const Parameters parameters_;
+  const char* name_;
 
   static_assert(exposedParameterCheck<Parameters, Exposed...>,
                 "Exposed parameter not found in module's parameter list");
@@ -26,6 +72,7 @@ public:
   ModuleHost(const char* moduleName, Parameters parameters)
     : exposed_(boost::hana::make_tuple(Parameter<Exposed>{moduleName}...))
     , parameters_(parameters)
+    , name_(moduleName)
   {
   }
 
@@ -33,15 +80,18 @@ public:
 
   auto& exposedParameters() const { return exposed_; }
 
-  template <class T>
+  template <class T, class Math = dsp::fastmath::Default>
   auto makeProcessor(const double sampleRate) const
   {
     const auto inputs = makeInputMap(parameters_);
 
     using Inputs = std::remove_const_t<decltype(inputs)>;
-    using Processor = typename Traits::template Processor<T, Inputs>;
+    using Processor = typename detail::ModuleProcessor<Traits, T, Inputs, Math>::type;
 
-    return ProcessorHost<Processor, Inputs, Parameter<Exposed>...>{inputs, sampleRate};
+    // Unnamed modules are reported by their type's name
+    const auto* name = *name_ ? name_ : detail::moduleTypeName<Traits>();
+    return ProcessorHost<Processor, Inputs, Parameter<Exposed>...>{inputs, sampleRate,
+                                                                   name};
   }
 
 private:
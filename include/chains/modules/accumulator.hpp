@@ -1,23 +1,38 @@
 #pragma once
 
+#include "chains/dsp/fixed_point.hpp"
 #include "chains/module.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
 namespace chains {
 
 namespace accumulator {
 
-struct Amount
+// The number of frames processed together by the block kernel
+static const int chunkSize = 8;
+
+struct Amount : CallbackParameter
 {
   static auto name() { return "Amount"; }
   static auto defaultValue() { return 1.0; }
 };
 
-struct Wrap
+struct Wrap : CallbackParameter
 {
   static auto name() { return "Wrap"; }
   static auto defaultValue() { return 1.0; }
 };
 
+// Adds each input multiplied by Amount to a running total, which wraps back by Wrap
+// when it reaches it.
+//
+// tick reads Amount and Wrap every sample, while blocks latch them at the start of the
+// block, so a change made during a block is heard from the next one. Changes within a
+// block are made by processing it in sub-blocks, e.g. with a ModulationMatrix, and each
+// sub-block matches ticking with the values it was given.
 struct Module
 {
   using Parameters = ParameterTraits<Amount, Wrap>;
@@ -40,11 +55,144 @@ struct Module
       return current_;
     }
 
-    Inputs inputs_;
+    // The accumulated values for each chunk of the block are found with a log-step
+    // prefix sum, written as plain loops over the chunk for the compiler to vectorize,
+    // and wrapped by subtracting the number of times they've passed the wrap value.
+    // This matches tick as long as the increments are less than the wrap value and
+    // not negative, otherwise the chunk is processed sample by sample.
+    void process(const T* in, T* out, int numFrames)
+    {
+      const auto amount = T(getValue<Amount>(inputs_));
+      const auto wrap = T(getValue<Wrap>(inputs_));
+      const auto wrapInv = T(1) / wrap;
+
+      for (auto offset = 0; offset < numFrames; offset += chunkSize) {
+        const auto frames = std::min(chunkSize, numFrames - offset);
+
+        T sum[chunkSize] = {};
+        for (auto i = 0; i < frames; ++i) {
+          sum[i] = in[offset + i] * amount;
+        }
+
+        auto inRange = wrap > T(0) && current_ >= T(0) && current_ < wrap;
+        for (auto i = 0; i < chunkSize; ++i) {
+          inRange &= sum[i] >= T(0) && sum[i] < wrap;
+        }
+
+        if (!inRange) {
+          for (auto i = 0; i < frames; ++i) {
+            current_ += sum[i];
+            current_ -= current_ >= wrap ? wrap : T(0);
+            out[offset + i] = current_;
+          }
+          continue;
+        }
+
+        for (auto shift = 1; shift < chunkSize; shift *= 2) {
+          for (auto i = chunkSize - 1; i >= shift; --i) {
+            sum[i] += sum[i - shift];
+          }
+        }
+
+        for (auto i = 0; i < frames; ++i) {
+          const auto ramp = current_ + sum[i];
+          out[offset + i] = ramp - std::floor(ramp * wrapInv) * wrap;
+        }
+
+        current_ = out[offset + frames - 1];
+      }
+    }
+
+    void reset() { current_ = T(0); }
+
+    template <class Visitor>
+    void visitState(Visitor& visit)
+    {
+      visit(&current_, 1);
+    }
+
     T current_ = T(0);
+    Inputs inputs_;
   };
 };
 
+// Fixed-point accumulators keep their total in 64 bits with the sample type's
+// fractional bits, so that totals and wrap values above 1 can be used, and the output
+// saturates at the ends of the sample type's range. Amount and Wrap are converted by
+// their inputs' callbacks when they change.
+template <class Storage, class Wide, int FractionalBits, class Inputs>
+struct Module::Processor<dsp::Fixed<Storage, Wide, FractionalBits>, Inputs>
+{
+  using T = dsp::Fixed<Storage, Wide, FractionalBits>;
+
+  Processor(const Inputs& inputs, double /* sampleRate */)
+    : amount_(getValue<Amount>(inputs))
+    , wrap_(fixedWrap(getValue<Wrap>(inputs)))
+    , inputs_(inputs)
+  {
+  }
+
+  void init()
+  {
+    setCallback<Amount>(inputs_, amountCallback());
+    setCallback<Wrap>(inputs_, wrapCallback());
+  }
+
+  void rebind()
+  {
+    rebindCallback<Amount>(inputs_, amountCallback());
+    rebindCallback<Wrap>(inputs_, wrapCallback());
+  }
+
+  auto amountCallback()
+  {
+    return [this](double amount) { amount_ = dsp::FixedGain{amount}; };
+  }
+
+  auto wrapCallback()
+  {
+    return [this](double wrap) { wrap_ = fixedWrap(wrap); };
+  }
+
+  static std::int64_t fixedWrap(const double wrap)
+  {
+    return std::int64_t(std::round(wrap * double(T::one)));
+  }
+
+  auto tick(const T& in) { return next(in); }
+
+  void process(const T* in, T* out, int numFrames)
+  {
+    for (auto i = 0; i < numFrames; ++i) {
+      out[i] = next(in[i]);
+    }
+  }
+
+  void reset() { current_ = 0; }
+
+  template <class Visitor>
+  void visitState(Visitor& visit)
+  {
+    visit(&current_, 1);
+  }
+
+  T next(const T in)
+  {
+    current_ += amount_.scale(in.raw());
+    if (current_ >= wrap_) {
+      current_ -= wrap_;
+    }
+    return T::fromRaw(Storage(current_ > T::maxRaw   ? T::maxRaw
+                              : current_ < T::minRaw ? T::minRaw
+                                                     : current_));
+  }
+
+  std::int64_t current_ = 0;
+  dsp::FixedGain amount_;
+  std::int64_t wrap_;
+  Inputs inputs_;
+};
+
 } // accumulator
 
 using Accumulator = accumulator::Module;
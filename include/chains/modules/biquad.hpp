@@ -35,24 +35,54 @@ struct Module
 {
   using Parameters = ParameterTraits<Frequency, Q, Type>;
 
-  template <class T, class Inputs>
+  template <class T, class Inputs, class Math = dsp::fastmath::Default>
   struct Processor
   {
     Processor(const Inputs& inputs, double sampleRate)
-      : inputs_(inputs), biquad_(sampleRate)
+      : biquad_(sampleRate), inputs_(inputs)
     {
     }
 
     void init()
     {
-      auto update = [this](double) { updateFilter(); };
+      const auto update = updateCallback();
       setCallback<Frequency>(inputs_, update);
       setCallback<Q>(inputs_, update);
       setCallback<Type>(inputs_, update);
     }
 
+    void rebind()
+    {
+      const auto update = updateCallback();
+      rebindCallback<Frequency>(inputs_, update);
+      rebindCallback<Q>(inputs_, update);
+      rebindCallback<Type>(inputs_, update);
+    }
+
+    auto updateCallback()
+    {
+      return [this](double) { updateFilter(); };
+    }
+
     auto tick(const T& in) { return biquad_.tick(in); }
 
+    void process(const T* in, T* out, int numFrames) { biquad_.process(in, out, numFrames); }
+
+    void prepare(double sampleRate, int /* maxBlockSize */)
+    {
+      biquad_.setSampleRate(sampleRate);
+    }
+
+    void reset() { biquad_.reset(); }
+
+    template <class Visitor>
+    void visitState(Visitor& visit)
+    {
+      biquad_.visitState(visit);
+    }
+
+    int tailLength() const { return biquad_.tailLength(); }
+
     void updateFilter()
     {
       biquad_.setFilter(filterType(), getValue<Frequency>(inputs_), getValue<Q>(inputs_));
@@ -61,16 +91,16 @@ struct Module
     auto filterType() const
     {
       switch (int(getValue<Type>(inputs_))) {
-      case 0: return dsp::Biquad<T>::Type::LowPass;
-      case 1: return dsp::Biquad<T>::Type::BandPass;
-      case 2: return dsp::Biquad<T>::Type::HighPass;
-      case 3: return dsp::Biquad<T>::Type::AllPass;
-      default: assert(false); return dsp::Biquad<T>::Type::LowPass;
+      case 0: return dsp::Biquad<T, Math>::Type::LowPass;
+      case 1: return dsp::Biquad<T, Math>::Type::BandPass;
+      case 2: return dsp::Biquad<T, Math>::Type::HighPass;
+      case 3: return dsp::Biquad<T, Math>::Type::AllPass;
+      default: assert(false); return dsp::Biquad<T, Math>::Type::LowPass;
       }
     }
 
+    dsp::Biquad<T, Math> biquad_;
     Inputs inputs_;
-    dsp::Biquad<T> biquad_;
   };
 }; // Module
 
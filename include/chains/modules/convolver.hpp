@@ -0,0 +1,143 @@
+#pragma once
+
+#include "chains/dsp/convolver.hpp"
+#include "chains/module.hpp"
+
+#include <boost/hana/tuple.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace chains {
+
+namespace convolver {
+
+// The base for impulse response declarations, which provide the impulse response's
+// samples, e.g.
+//
+// struct Room : convolver::ImpulseResponse
+// {
+//   static std::vector<double> samples() { return loadRoom(); }
+// };
+//
+// const auto reverb = module<Convolver<Room>>();
+struct ImpulseResponse
+{
+  // The number of frames in each of the impulse response's partitions
+  static int partitionSize() { return 128; }
+
+  // Whether the first partition should be convolved directly, avoiding latency
+  static bool zeroLatency() { return true; }
+};
+
+// The partitioned impulse response is prepared once, and then shared by all
+// convolvers using it
+template <class T, class Source>
+auto sharedImpulseResponse()
+{
+  static const auto ir = std::make_shared<const dsp::PartitionedImpulseResponse<T>>(
+    Source::samples(), Source::partitionSize(), Source::zeroLatency());
+  return ir;
+}
+
+// Convolves with a partitioned impulse response, shared with the other processors
+// using it
+template <class T>
+struct ConvolverProcessor
+{
+  using ImpulseResponsePtr = std::shared_ptr<const dsp::PartitionedImpulseResponse<T>>;
+
+  explicit ConvolverProcessor(ImpulseResponsePtr ir) : convolver_(std::move(ir))
+  {
+  }
+
+  auto tick(const T& in) { return convolver_.tick(in); }
+  void process(const T* in, T* out, int numFrames)
+  {
+    convolver_.process(in, out, numFrames);
+  }
+
+  void reset() { convolver_.reset(); }
+
+  template <class Visitor>
+  void visitState(Visitor& visit)
+  {
+    convolver_.visitState(visit);
+  }
+  int latency() const { return convolver_.latency(); }
+  int tailLength() const { return convolver_.tailLength(); }
+  std::size_t heapSize() const { return convolver_.heapSize(); }
+
+  dsp::Convolver<T> convolver_;
+};
+
+template <class Source>
+struct Module
+{
+  template <class T, class Inputs>
+  struct Processor : ConvolverProcessor<T>
+  {
+    Processor(const Inputs&, double /* sampleRate */)
+      : ConvolverProcessor<T>(sharedImpulseResponse<T, Source>())
+    {
+    }
+  };
+};
+
+// A convolver module for an impulse response that's loaded at runtime, e.g. from a
+// file, rather than declared as a type. It's used in chains like any other module,
+// with the processors made from it sharing the impulse response, e.g.
+//
+// const auto ir = std::make_shared<const dsp::PartitionedImpulseResponse<float>>(
+//   loadRoom(), 128, true);
+// const auto reverb = serial(convolver::withImpulseResponse(ir));
+template <class U>
+class SharedModule
+{
+  using ImpulseResponsePtr = std::shared_ptr<const dsp::PartitionedImpulseResponse<U>>;
+
+  // The processor is made from the impulse response in place of the module's inputs
+  struct Processor : ConvolverProcessor<U>
+  {
+    Processor(const ImpulseResponsePtr& ir, double /* sampleRate */)
+      : ConvolverProcessor<U>(ir)
+    {
+    }
+  };
+
+  ImpulseResponsePtr ir_;
+  const char* name_;
+
+public:
+  SharedModule(ImpulseResponsePtr ir, const char* name) : ir_(std::move(ir)), name_(name)
+  {
+  }
+
+  auto named(const char* name) const { return SharedModule{ir_, name}; }
+
+  auto exposedParameters() const { return boost::hana::make_tuple(); }
+
+  template <class T, class Math = dsp::fastmath::Default>
+  auto makeProcessor(const double sampleRate) const
+  {
+    static_assert(std::is_same<T, U>::value,
+                  "The impulse response needs to be partitioned for the chain's type");
+    const auto* name = *name_ ? name_ : detail::moduleTypeName<SharedModule>();
+    return ProcessorHost<Processor, ImpulseResponsePtr>{ir_, sampleRate, name};
+  }
+};
+
+template <class T>
+auto withImpulseResponse(std::shared_ptr<const dsp::PartitionedImpulseResponse<T>> ir,
+                         const char* name = "")
+{
+  return SharedModule<T>{std::move(ir), name};
+}
+
+} // convolver
+
+template <class ImpulseResponse>
+using Convolver = convolver::Module<ImpulseResponse>;
+
+} // chains
@@ -1,39 +1,231 @@
 #pragma once
 
+#include "chains/bus.hpp"
+#include "chains/dsp/fade_curves.hpp"
+#include "chains/dsp/fixed_point.hpp"
 #include "chains/module.hpp"
 
+#include <array>
+
 namespace chains {
 
 namespace crossfade {
 
-struct Fade
+struct Fade : CallbackParameter
 {
   static auto name() { return "Fade"; }
   static auto defaultValue() { return 0.0; }
+  static auto minimumValue() { return 0.0; }
+  static auto maximumValue() { return 1.0; }
+};
+
+struct Curve : CallbackParameter
+{
+  static auto name() { return "Curve"; }
+  static auto defaultValue() { return 0.0; }
+  static auto minimumValue() { return 0.0; }
+  static auto maximumValue() { return 3.0; }
 };
 
+// Curve values outside of the range of curves are clamped to the nearest curve
+inline dsp::FadeCurve curveFromValue(const double value)
+{
+  const auto last = double(dsp::FadeCurve::Logarithmic);
+  return dsp::FadeCurve(int(!(value > 0.0) ? 0.0 : value < last ? value : last));
+}
+
 struct Module
 {
-  using Parameters = ParameterTraits<Fade>;
+  using Parameters = ParameterTraits<Fade, Curve>;
 
-  template <class T, class Inputs>
+  template <class T, class Inputs, class Math = dsp::fastmath::Default>
   struct Processor
   {
-    Processor(const Inputs& inputs, double /* sampleRate */) : inputs_(inputs) {}
+    Processor(const Inputs& inputs, double /* sampleRate */)
+      : fade_(T(getValue<Fade>(inputs))), inputs_(inputs)
+    {
+    }
 
     auto tick(const std::array<T, 2>& in)
     {
-      const auto fade = getValue<Fade>(inputs_);
-      const auto fadeInv = T(1) - fade;
+      fade_ = T(getValue<Fade>(inputs_));
+      return in[0] * dsp::fadeGain<Math>(curve(), T(1) - fade_)
+             + in[1] * dsp::fadeGain<Math>(curve(), fade_);
+    }
+
+    // Processes a block of samples, with the fade moving smoothly over the block from
+    // its previous value to the current value
+    void process(const std::array<const T*, 2>& in, T* out, int numFrames)
+    {
+      processInput(in, out, numFrames);
+    }
+
+    // Planar buses are processed with contiguous loops, and interleaved buses through
+    // their channels' strided views
+    void process(const Bus<const T, 2>& in, T* out, int numFrames)
+    {
+      if (in.isPlanar()) {
+        processInput(in.channelPointers(), out, numFrames);
+      } else {
+        processInput(in, out, numFrames);
+      }
+    }
+
+    template <class Input>
+    void processInput(const Input& in, T* out, int numFrames)
+    {
+      switch (curve()) {
+      case dsp::FadeCurve::Linear:
+        processCurve<dsp::FadeCurve::Linear>(in, out, numFrames);
+        break;
+      case dsp::FadeCurve::EqualPower:
+        processCurve<dsp::FadeCurve::EqualPower>(in, out, numFrames);
+        break;
+      case dsp::FadeCurve::SCurve:
+        processCurve<dsp::FadeCurve::SCurve>(in, out, numFrames);
+        break;
+      case dsp::FadeCurve::Logarithmic:
+        processCurve<dsp::FadeCurve::Logarithmic>(in, out, numFrames);
+        break;
+      }
+    }
 
-      // TODO non-linear fades
-      return in[0] * fadeInv + in[1] * fade;
+    int tailLength() const { return 0; }
+
+    // The fade's position, which the next block ramps from
+    template <class Visitor>
+    void visitState(Visitor& visit)
+    {
+      visit(&fade_, 1);
     }
 
+    auto curve() const { return curveFromValue(getValue<Curve>(inputs_)); }
+
+    template <dsp::FadeCurve FadeCurve, class Input>
+    void processCurve(const Input& in, T* out, int numFrames)
+    {
+      const auto start = fade_;
+      const auto step = (T(getValue<Fade>(inputs_)) - start) / T(numFrames);
+
+      for (auto i = 0; i < numFrames; ++i) {
+        const auto fade = start + step * T(i + 1);
+        out[i] = in[0][i] * dsp::fadeGain<FadeCurve, Math>(T(1) - fade)
+                 + in[1][i] * dsp::fadeGain<FadeCurve, Math>(fade);
+      }
+
+      if (numFrames > 0) {
+        fade_ = T(getValue<Fade>(inputs_));
+      }
+    }
+
+    T fade_;
     Inputs inputs_;
   };
 };
 
+// Fixed-point crossfades calculate their target gains in floating point from the Fade
+// and Curve inputs' callbacks when they change, and ramp the gains linearly in fixed
+// point over each block, so the gains follow the curve at the ends of each block and are
+// linear in between
+template <class Storage, class Wide, int FractionalBits, class Inputs, class Math>
+struct Module::Processor<dsp::Fixed<Storage, Wide, FractionalBits>, Inputs, Math>
+{
+  using T = dsp::Fixed<Storage, Wide, FractionalBits>;
+
+  Processor(const Inputs& inputs, double /* sampleRate */)
+    : gains_(gainsFor(getValue<Fade>(inputs), curveFromValue(getValue<Curve>(inputs))))
+    , targetGains_(gains_)
+    , inputs_(inputs)
+  {
+  }
+
+  void init()
+  {
+    const auto update = updateCallback();
+    setCallback<Fade>(inputs_, update);
+    setCallback<Curve>(inputs_, update);
+  }
+
+  void rebind()
+  {
+    const auto update = updateCallback();
+    rebindCallback<Fade>(inputs_, update);
+    rebindCallback<Curve>(inputs_, update);
+  }
+
+  auto updateCallback()
+  {
+    return [this](double) { targetGains_ = gainsFor(getValue<Fade>(inputs_), curve()); };
+  }
+
+  auto tick(const std::array<T, 2>& in)
+  {
+    gains_ = targetGains_;
+    return in[0] * gains_[0] + in[1] * gains_[1];
+  }
+
+  void process(const std::array<const T*, 2>& in, T* out, int numFrames)
+  {
+    processInput(in, out, numFrames);
+  }
+
+  void process(const Bus<const T, 2>& in, T* out, int numFrames)
+  {
+    if (in.isPlanar()) {
+      processInput(in.channelPointers(), out, numFrames);
+    } else {
+      processInput(in, out, numFrames);
+    }
+  }
+
+  template <class Input>
+  void processInput(const Input& in, T* out, int numFrames)
+  {
+    if (numFrames <= 0) {
+      return;
+    }
+
+    const auto start = gains_;
+    const auto end = targetGains_;
+    gains_ = end;
+
+    auto gain0 = Wide(start[0].raw());
+    auto gain1 = Wide(start[1].raw());
+    const auto step0 = (Wide(end[0].raw()) - gain0) / numFrames;
+    const auto step1 = (Wide(end[1].raw()) - gain1) / numFrames;
+
+    for (auto i = 0; i < numFrames - 1; ++i) {
+      gain0 += step0;
+      gain1 += step1;
+      out[i] = in[0][i] * T::saturate(gain0) + in[1][i] * T::saturate(gain1);
+    }
+
+    const auto last = numFrames - 1;
+    out[last] = in[0][last] * end[0] + in[1][last] * end[1];
+  }
+
+  int tailLength() const { return 0; }
+
+  // The gains that the next block ramps from
+  template <class Visitor>
+  void visitState(Visitor& visit)
+  {
+    visit(gains_.data(), gains_.size());
+  }
+
+  auto curve() const { return curveFromValue(getValue<Curve>(inputs_)); }
+
+  static std::array<T, 2> gainsFor(const double fade, const dsp::FadeCurve curve)
+  {
+    return {{T(dsp::fadeGain<Math>(curve, 1.0 - fade)),
+             T(dsp::fadeGain<Math>(curve, fade))}};
+  }
+
+  std::array<T, 2> gains_;
+  std::array<T, 2> targetGains_;
+  Inputs inputs_;
+};
+
 } // crossfade
 
 using Crossfade = crossfade::Module;
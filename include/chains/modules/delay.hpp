@@ -2,7 +2,9 @@
 
 #include "chains/module.hpp"
 
-#include "boost/circular_buffer.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
 
 namespace chains {
 
@@ -26,19 +28,44 @@ struct Module
   struct Processor
   {
     Processor(const Inputs& inputs, double sampleRate)
-      : inputs_(inputs), buffer_(bufferSize)
+      : buffer_(bufferSize, T(0)), inputs_(inputs)
     {
-      buffer_.resize(bufferSize, T(0));
     }
 
+    // The buffer is a ring, with position_ pointing at the slot for the next input
     auto tick(T in)
     {
-      buffer_.push_back(in);
-      return *(buffer_.rbegin() + std::size_t(getValue<Length>(inputs_)));
+      buffer_[position_] = in;
+
+      auto read = position_ - int(getValue<Length>(inputs_));
+      if (read < 0) {
+        read += bufferSize;
+      }
+
+      if (++position_ == bufferSize) {
+        position_ = 0;
+      }
+
+      return buffer_[read];
     }
 
+    int tailLength() const { return int(getValue<Length>(inputs_)); }
+
+    void reset() { std::fill(buffer_.begin(), buffer_.end(), T(0)); }
+
+    template <class Visitor>
+    void visitState(Visitor& visit)
+    {
+      visit(&position_, 1);
+      visit(buffer_.data(), buffer_.size());
+    }
+
+    std::size_t heapSize() const { return buffer_.capacity() * sizeof(T); }
+
+    // Hot state first, in the order that tick uses it
+    int position_ = 0;
+    std::vector<T> buffer_;
     Inputs inputs_;
-    boost::circular_buffer<T> buffer_;
   };
 };
 
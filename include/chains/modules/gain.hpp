@@ -1,12 +1,13 @@
 #pragma once
 
+#include "chains/dsp/fixed_point.hpp"
 #include "chains/module.hpp"
 
 namespace chains {
 
 namespace gain {
 
-struct Gain
+struct Gain : CallbackParameter
 {
   static auto name() { return "Gain"; }
   static auto defaultValue() { return 1.0; }
@@ -21,12 +22,50 @@ struct Module
   {
     Processor(const Inputs& inputs, double /* sampleRate */) : inputs_(inputs) {}
 
-    auto tick(const T& in) { return in * getValue<Gain>(inputs_); }
+    auto tick(const T& in) { return in * T(getValue<Gain>(inputs_)); }
+
+    int tailLength() const { return 0; }
 
     Inputs inputs_;
   };
 };
 
+// Fixed-point gains are applied with a dsp::FixedGain multiplier, so that gains above 1
+// can be used, and the multiplier is recalculated by the Gain input's callback when the
+// gain changes
+template <class Storage, class Wide, int FractionalBits, class Inputs>
+struct Module::Processor<dsp::Fixed<Storage, Wide, FractionalBits>, Inputs>
+{
+  using T = dsp::Fixed<Storage, Wide, FractionalBits>;
+
+  Processor(const Inputs& inputs, double /* sampleRate */)
+    : multiplier_(getValue<Gain>(inputs)), inputs_(inputs)
+  {
+  }
+
+  void init() { setCallback<Gain>(inputs_, gainCallback()); }
+  void rebind() { rebindCallback<Gain>(inputs_, gainCallback()); }
+
+  auto gainCallback()
+  {
+    return [this](double gain) { multiplier_ = dsp::FixedGain{gain}; };
+  }
+
+  auto tick(const T& in) { return multiplier_(in); }
+
+  void process(const T* in, T* out, int numFrames)
+  {
+    for (auto i = 0; i < numFrames; ++i) {
+      out[i] = multiplier_(in[i]);
+    }
+  }
+
+  int tailLength() const { return 0; }
+
+  dsp::FixedGain multiplier_;
+  Inputs inputs_;
+};
+
 } // gain
 
 using Gain = gain::Module;
@@ -0,0 +1,260 @@
+#pragma once
+
+#include "chains/module.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace chains {
+
+namespace multi_tap_delay {
+
+// The longest tap, in samples
+static const int maxLength = 4096;
+
+// The buffer has room for a chunk of a block to be written ahead of the longest tap
+static const int bufferSize = 8192;
+static const int chunkSize = bufferSize - maxLength - 1;
+
+// The delay of tap number Tap in samples, which can be fractional, e.g.
+// multi_tap_delay::TapLength<0> for the first tap.
+// Taps default to no delay, like delay::Length.
+template <int Tap>
+struct TapLength : CallbackParameter
+{
+  static auto name()
+  {
+    static const auto name = "Tap " + std::to_string(Tap + 1) + " Length";
+    return name.c_str();
+  }
+  static auto defaultValue() { return 0.0; }
+  static auto minimumValue() { return 0.0; }
+  static auto maximumValue() { return double(maxLength); }
+};
+
+// The gain of tap number Tap. Only the first tap is heard by default, so that an
+// unconfigured delay passes its input through unchanged like a Delay, rather than
+// summing every tap at the same position.
+template <int Tap>
+struct TapGain : CallbackParameter
+{
+  static auto name()
+  {
+    static const auto name = "Tap " + std::to_string(Tap + 1) + " Gain";
+    return name.c_str();
+  }
+  static auto defaultValue() { return Tap == 0 ? 1.0 : 0.0; }
+  static auto minimumValue() { return -1.0; }
+  static auto maximumValue() { return 1.0; }
+};
+
+template <class Taps>
+struct TapParameters;
+
+template <int... Tap>
+struct TapParameters<std::integer_sequence<int, Tap...>>
+{
+  using type = decltype(std::tuple_cat(std::tuple<TapLength<Tap>, TapGain<Tap>>{}...));
+};
+
+// A delay line with a single write position and NumTaps read taps, each with its own
+// length and gain, which are summed to the output.
+//
+// Fractional lengths are read with linear interpolation. Blocks are written to the
+// buffer in chunks, and then each tap is gathered from the buffer into the output with
+// a contiguous loop, so that the compiler can vectorize it. Each tap's delay and gains
+// are recalculated by its inputs' callbacks when its length or gain changes.
+template <int NumTaps>
+struct Module
+{
+  using Parameters =
+    typename TapParameters<std::make_integer_sequence<int, NumTaps>>::type;
+
+  template <class T, class Inputs>
+  struct Processor
+  {
+    Processor(const Inputs& inputs, double /* sampleRate */)
+      : buffer_(bufferSize, T(0)), inputs_(inputs)
+    {
+      updateTaps(std::make_integer_sequence<int, NumTaps>{});
+    }
+
+    void init() { setCallbacks(std::make_integer_sequence<int, NumTaps>{}); }
+    void rebind() { rebindCallbacks(std::make_integer_sequence<int, NumTaps>{}); }
+
+    auto tick(T in)
+    {
+      buffer_[position_] = in;
+
+      auto out = T(0);
+      for (const auto& tap : taps_) {
+        const auto newer = (position_ - tap.delay) & mask;
+        const auto older = (newer - 1) & mask;
+        out += buffer_[newer] * tap.newerGain + buffer_[older] * tap.olderGain;
+      }
+
+      position_ = (position_ + 1) & mask;
+      return out;
+    }
+
+    void process(const T* in, T* out, int numFrames)
+    {
+      for (auto offset = 0; offset < numFrames; offset += chunkSize) {
+        processChunk(in + offset, out + offset, std::min(chunkSize, numFrames - offset));
+      }
+    }
+
+    int tailLength() const
+    {
+      return tailLength(std::make_integer_sequence<int, NumTaps>{});
+    }
+
+    void reset() { std::fill(buffer_.begin(), buffer_.end(), T(0)); }
+
+    template <class Visitor>
+    void visitState(Visitor& visit)
+    {
+      visit(&position_, 1);
+      visit(buffer_.data(), buffer_.size());
+    }
+
+    std::size_t heapSize() const { return buffer_.capacity() * sizeof(T); }
+
+    static const int mask = bufferSize - 1;
+
+    // A tap reads the sample written delay samples ago, and the one before it for the
+    // fractional part of its length
+    struct Tap
+    {
+      int delay;
+      T newerGain;
+      T olderGain;
+    };
+
+    void processChunk(const T* in, T* out, const int numFrames)
+    {
+      // The input is written first, the chunk is short enough not to reach the taps
+      const auto firstWrite = std::min(numFrames, bufferSize - position_);
+      std::copy_n(in, firstWrite, buffer_.data() + position_);
+      std::copy_n(in + firstWrite, numFrames - firstWrite, buffer_.data());
+
+      std::fill_n(out, numFrames, T(0));
+      for (const auto& tap : taps_) {
+        gatherTap(tap, out, numFrames);
+      }
+
+      position_ = (position_ + numFrames) & mask;
+    }
+
+    // Adds the tap's output for the chunk, in up to three contiguous runs that are split
+    // where the reads wrap around the end of the buffer
+    void gatherTap(const Tap& tap, T* out, const int numFrames) const
+    {
+      const auto* buffer = buffer_.data();
+      auto i = 0;
+      while (i < numFrames) {
+        const auto newer = (position_ - tap.delay + i) & mask;
+        if (newer == 0) {
+          out[i] += buffer[0] * tap.newerGain + buffer[mask] * tap.olderGain;
+          ++i;
+          continue;
+        }
+
+        const auto count = std::min(numFrames - i, bufferSize - newer);
+        gather(buffer + newer, out + i, count, tap.newerGain, tap.olderGain);
+        i += count;
+      }
+    }
+
+    // out[i] += newer[i] * newerGain + newer[i - 1] * olderGain
+    static void gather(const T* newer, T* out, const int count, T newerGain, T olderGain)
+    {
+      for (auto i = 0; i < count; ++i) {
+        out[i] += newer[i] * newerGain + newer[i - 1] * olderGain;
+      }
+    }
+
+    template <int Index>
+    auto tapCallback()
+    {
+      return [this](double) {
+        updateTap(taps_[Index],
+                  getValue<TapLength<Index>>(inputs_),
+                  getValue<TapGain<Index>>(inputs_));
+      };
+    }
+
+    template <int... Index>
+    void setCallbacks(std::integer_sequence<int, Index...>)
+    {
+      std::initializer_list<int>{
+        (setCallback<TapLength<Index>>(inputs_, tapCallback<Index>()),
+         setCallback<TapGain<Index>>(inputs_, tapCallback<Index>()),
+         0)...};
+    }
+
+    template <int... Index>
+    void rebindCallbacks(std::integer_sequence<int, Index...>)
+    {
+      std::initializer_list<int>{
+        (rebindCallback<TapLength<Index>>(inputs_, tapCallback<Index>()),
+         rebindCallback<TapGain<Index>>(inputs_, tapCallback<Index>()),
+         0)...};
+    }
+
+    template <int... Index>
+    void updateTaps(std::integer_sequence<int, Index...>)
+    {
+      std::initializer_list<int>{(updateTap(taps_[Index],
+                                            getValue<TapLength<Index>>(inputs_),
+                                            getValue<TapGain<Index>>(inputs_)),
+                                  0)...};
+    }
+
+    template <int... Index>
+    int tailLength(std::integer_sequence<int, Index...>) const
+    {
+      return std::max({0, tapTailLength(getValue<TapLength<Index>>(inputs_))...});
+    }
+
+    static double clampLength(const double length)
+    {
+      return std::max(0.0, std::min(length, double(maxLength)));
+    }
+
+    static int tapTailLength(const double length)
+    {
+      return int(std::ceil(clampLength(length))) + 1;
+    }
+
+    static void updateTap(Tap& tap, const double length, const double gain)
+    {
+      const auto clamped = clampLength(length);
+      const auto delay = std::floor(clamped);
+      const auto fraction = clamped - delay;
+      tap.delay = int(delay);
+      tap.newerGain = T(gain * (1.0 - fraction));
+      tap.olderGain = T(gain * fraction);
+    }
+
+    // Hot state first, in the order that processing uses it
+    std::array<Tap, NumTaps> taps_{};
+    int position_ = 0;
+    std::vector<T> buffer_;
+    Inputs inputs_;
+  };
+};
+
+} // multi_tap_delay
+
+template <int NumTaps>
+using MultiTapDelay = multi_tap_delay::Module<NumTaps>;
+
+} // chains
@@ -14,6 +14,11 @@ struct Frequency : CallbackParameter
   static auto minimumValue() { return 0.0; }
 };
 
+// A phasor running at Frequency, see dsp::Phasor.
+//
+// Frequency changes are applied by the input's callback, and blocks ramp with the
+// frequency that was set when they started, so changes within a block are made by
+// processing it in sub-blocks, e.g. with a ModulationMatrix.
 struct Module
 {
   using Parameters = ParameterTraits<Frequency>;
@@ -22,20 +27,38 @@ struct Module
   struct Processor
   {
     Processor(const Inputs& inputs, double sampleRate)
-      : inputs_(inputs), phasor_(sampleRate)
+      : phasor_(sampleRate), inputs_(inputs)
     {
     }
 
-    void init()
+    void init() { setCallback<Frequency>(inputs_, frequencyCallback()); }
+    void rebind() { rebindCallback<Frequency>(inputs_, frequencyCallback()); }
+
+    auto frequencyCallback()
     {
-      setCallback<Frequency>(
-        inputs_, [this](double value) { phasor_.setFrequency(value); });
+      return [this](double value) { phasor_.setFrequency(value); };
     }
 
     auto tick(T /*in*/) { return phasor_.tick(); }
 
-    Inputs inputs_;
+    // Frequency changes take effect at the start of the next block
+    void process(const T* /*in*/, T* out, int numFrames) { phasor_.process(out, numFrames); }
+
+    void prepare(double sampleRate, int /* maxBlockSize */)
+    {
+      phasor_.setSampleRate(sampleRate);
+    }
+
+    void reset() { phasor_.reset(); }
+
+    template <class Visitor>
+    void visitState(Visitor& visit)
+    {
+      phasor_.visitState(visit);
+    }
+
     dsp::Phasor<T> phasor_;
+    Inputs inputs_;
   };
 };
 
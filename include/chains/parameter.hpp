@@ -2,8 +2,10 @@
 
 #include "chains/support/estd.hpp"
 
+#include <cstddef>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <string>
 
 namespace chains {
@@ -15,14 +17,39 @@ struct CallbackParameter
 {
 };
 
+// The callback is rarely used once a processor is running, so it's held out of line,
+// keeping the input's value close to the processor's other state
 class CallbackInput
 {
   double value_ = 0.0;
-  ValueCallback callback_;
+  std::unique_ptr<ValueCallback> callback_;
 
 public:
+  // The value is read by the callback when it changes rather than while processing,
+  // so none of the input's state is hot, see footprint.hpp
+  static constexpr std::size_t hotStateSize = 0;
+
   explicit CallbackInput(const double value) : value_(value) {}
 
+  CallbackInput(const CallbackInput& other)
+    : value_(other.value_)
+    , callback_(other.callback_ ? std::make_unique<ValueCallback>(*other.callback_)
+                                : nullptr)
+  {
+  }
+
+  CallbackInput(CallbackInput&&) = default;
+
+  CallbackInput& operator=(const CallbackInput& other)
+  {
+    value_ = other.value_;
+    callback_ =
+      other.callback_ ? std::make_unique<ValueCallback>(*other.callback_) : nullptr;
+    return *this;
+  }
+
+  CallbackInput& operator=(CallbackInput&&) = default;
+
   auto value() const { return value_; }
 
   void setValue(const double value)
@@ -30,15 +57,36 @@ public:
     const auto oldValue = value_;
     value_ = value;
     if (oldValue != value) {
-      callback_(value);
+      notify();
+    }
+  }
+
+  // Sets the value without calling the callback, used when several values are changed
+  // together and the callbacks should only see the complete change, see notify
+  void setValueQuietly(const double value) { value_ = value; }
+
+  // Calls the callback with the current value
+  void notify()
+  {
+    if (callback_) {
+      (*callback_)(value_);
     }
   }
 
   void setCallback(ValueCallback callback)
   {
-    callback_ = callback;
-    callback_(value_);
+    rebindCallback(std::move(callback));
+    notify();
+  }
+
+  // Replaces the callback without calling it, used when a copied processor needs its
+  // callbacks pointing at itself, and its derived state is already up to date
+  void rebindCallback(ValueCallback callback)
+  {
+    callback_ = std::make_unique<ValueCallback>(std::move(callback));
   }
+
+  std::size_t heapSize() const { return callback_ ? sizeof(ValueCallback) : 0; }
 };
 
 class Input
@@ -46,10 +94,14 @@ class Input
   double value_ = 0.0;
 
 public:
+  static constexpr std::size_t hotStateSize = sizeof(double);
+
   explicit Input(const double value) : value_(value) {}
 
   auto value() const { return value_; }
   void setValue(const double value) { value_ = value; }
+
+  std::size_t heapSize() const { return 0; }
 };
 
 class Constant
@@ -57,11 +109,16 @@ class Constant
   const double value_;
 
 public:
+  static constexpr std::size_t hotStateSize = sizeof(double);
+
   explicit Constant(const double value) : value_(value) {}
 
   auto value() const { return value_; }
 
   void setCallback(ValueCallback&& callback) { callback(value_); }
+  void rebindCallback(ValueCallback&&) {}
+
+  std::size_t heapSize() const { return 0; }
 };
 
 
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "chains/parameter.hpp"
+
+#include <boost/hana/for_each.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chains {
+
+// A value for each of a chain's exposed parameters, in the same order as the chain's
+// exposedParameters and its processor's exposedInputs
+class ParameterSet
+{
+public:
+  ParameterSet() = default;
+  explicit ParameterSet(std::vector<double> values) : values_(std::move(values)) {}
+
+  // Makes a set with the chain's default values
+  template <class Chain>
+  static ParameterSet defaults(const Chain& chain)
+  {
+    ParameterSet set;
+    boost::hana::for_each(chain.exposedParameters(), [&set](const auto& parameter) {
+      set.values_.push_back(parameter.defaultValue());
+    });
+    return set;
+  }
+
+  int size() const { return int(values_.size()); }
+
+  double operator[](const int index) const { return values_[index]; }
+  double& operator[](const int index) { return values_[index]; }
+
+  const double* data() const { return values_.data(); }
+  double* data() { return values_.data(); }
+
+  bool operator==(const ParameterSet& other) const { return values_ == other.values_; }
+  bool operator!=(const ParameterSet& other) const { return values_ != other.values_; }
+
+private:
+  std::vector<double> values_;
+};
+
+// The names of a chain's exposed parameters, in the order used by ParameterSet
+template <class Chain>
+std::vector<std::string> parameterNames(const Chain& chain)
+{
+  std::vector<std::string> names;
+  boost::hana::for_each(chain.exposedParameters(), [&names](const auto& parameter) {
+    names.push_back(parameter.name());
+  });
+  return names;
+}
+
+namespace detail {
+
+template <class Input>
+struct ParameterSetInput
+{
+  static void setValue(void* input, const double value)
+  {
+    static_cast<Input*>(input)->setValue(value);
+  }
+
+  static constexpr void (*notify)(void*) = nullptr;
+};
+
+// Callback inputs are set without their callbacks, which are called once all of the
+// set's values are in place
+template <>
+struct ParameterSetInput<CallbackInput>
+{
+  static void setValue(void* input, const double value)
+  {
+    static_cast<CallbackInput*>(input)->setValueQuietly(value);
+  }
+
+  static void notify(void* input) { static_cast<CallbackInput*>(input)->notify(); }
+};
+
+// out[i] = sum(weights[k] * sets[k][i]), with a pass per set so that it vectorizes
+inline void morphValues(const ParameterSet* const* sets,
+                        const double* weights,
+                        const int numSets,
+                        double* out,
+                        const int count)
+{
+  const auto* first = sets[0]->data();
+  const auto firstWeight = weights[0];
+  for (auto i = 0; i < count; ++i) {
+    out[i] = firstWeight * first[i];
+  }
+  for (auto set = 1; set < numSets; ++set) {
+    const auto* values = sets[set]->data();
+    const auto weight = weights[set];
+    for (auto i = 0; i < count; ++i) {
+      out[i] += weight * values[i];
+    }
+  }
+}
+
+} // detail
+
+// Applies complete parameter sets to a processor's exposed inputs at block boundaries.
+//
+// Sets are applied in two passes: the inputs whose values have changed are updated
+// first, and then the callbacks of the changed callback inputs are called, once each,
+// so that callbacks never see a partly applied set and unchanged inputs don't trigger
+// their callbacks.
+//
+// A control thread publishes sets with publish, which copies the set into a pending
+// buffer, and the audio thread picks the set up at the start of its next block. The
+// pending buffer and the applied values form a double buffer, handed over with an
+// atomic flag, so the audio thread doesn't allocate or lock. Publishing should be done
+// from a single thread.
+//
+// The audio thread can also morph between sets, interpolating each block's values from
+// two or more sets with a weight for each set.
+class PresetSwitcher
+{
+public:
+  template <class Processor>
+  explicit PresetSwitcher(Processor& processor)
+  {
+    std::vector<double> values;
+    boost::hana::for_each(processor.exposedInputs(), [&](auto* input) {
+      using Input = std::remove_pointer_t<decltype(input)>;
+      inputs_.push_back({input, &detail::ParameterSetInput<Input>::setValue,
+                         detail::ParameterSetInput<Input>::notify});
+      values.push_back(input->value());
+    });
+    current_ = ParameterSet{std::move(values)};
+    pending_ = current_;
+    morphed_ = current_;
+    changed_.reserve(inputs_.size());
+  }
+
+  PresetSwitcher(const PresetSwitcher&) = delete;
+  PresetSwitcher& operator=(const PresetSwitcher&) = delete;
+
+  int size() const { return int(inputs_.size()); }
+
+  // Hands a set over to the audio thread, returning false if the previously published
+  // set hasn't been applied yet. Called from the control thread.
+  bool publish(const ParameterSet& set)
+  {
+    assert(set.size() == size());
+    if (hasPending_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    std::copy_n(set.data(), size(), pending_.data());
+    hasPending_.store(true, std::memory_order_release);
+    return true;
+  }
+
+  // Applies the published set if there is one, returning true if a set was applied.
+  // Called from the audio thread between blocks.
+  bool applyPending()
+  {
+    if (!hasPending_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    apply(pending_.data());
+    hasPending_.store(false, std::memory_order_release);
+    return true;
+  }
+
+  // Applies a set immediately, called from the audio thread between blocks
+  void apply(const ParameterSet& set)
+  {
+    assert(set.size() == size());
+    apply(set.data());
+  }
+
+  // Applies the weighted sum of numSets sets, called from the audio thread between
+  // blocks. The weights would normally add up to 1.
+  void morph(const ParameterSet* const* sets, const double* weights, const int numSets)
+  {
+    assert(numSets > 0);
+    detail::morphValues(sets, weights, numSets, morphed_.data(), size());
+    apply(morphed_.data());
+  }
+
+  // Morphs between two sets, with position 0 giving a and 1 giving b
+  void morph(const ParameterSet& a, const ParameterSet& b, const double position)
+  {
+    const ParameterSet* sets[] = {&a, &b};
+    const double weights[] = {1.0 - position, position};
+    morph(sets, weights, 2);
+  }
+
+  // Applies any published set, and then processes a block with the processor
+  template <class Processor, class T>
+  void process(Processor& processor, const T* in, T* out, const int numFrames)
+  {
+    applyPending();
+    processor.process(in, out, numFrames);
+  }
+
+  // The values that have been applied, only safe to use from the audio thread
+  const ParameterSet& current() const { return current_; }
+
+private:
+  void apply(const double* values)
+  {
+    changed_.clear();
+    for (auto i = 0; i < size(); ++i) {
+      if (values[i] != current_[i]) {
+        current_[i] = values[i];
+        inputs_[i].setValue(inputs_[i].input, values[i]);
+        if (inputs_[i].notify) {
+          changed_.push_back(i);
+        }
+      }
+    }
+
+    for (const auto i : changed_) {
+      inputs_[i].notify(inputs_[i].input);
+    }
+  }
+
+  struct BoundInput
+  {
+    void* input;
+    // Sets the input's value without calling its callback
+    void (*setValue)(void* input, double value);
+    // Calls the input's callback, nullptr for inputs without callbacks
+    void (*notify)(void* input);
+  };
+
+  std::vector<BoundInput> inputs_;
+  std::vector<int> changed_;
+
+  // Owned by the audio thread
+  ParameterSet current_;
+  ParameterSet morphed_;
+
+  // Passed from the control thread to the audio thread
+  ParameterSet pending_;
+  std::atomic<bool> hasPending_{false};
+};
+
+} // chains
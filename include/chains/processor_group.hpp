@@ -1,15 +1,112 @@
 #pragma once
 
+#include "chains/footprint.hpp"
+#include "chains/processor_host.hpp"
+#include "chains/support/estd.hpp"
+
 #include <boost/hana/flatten.hpp>
 #include <boost/hana/for_each.hpp>
 #include <boost/hana/transform.hpp>
+#include <boost/hana/tuple.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <vector>
 
 namespace chains {
 
+namespace detail {
+
+template <class T, class Processors>
+struct AllMonoProcessors;
+
+template <class T, class... Processors>
+struct AllMonoProcessors<T, boost::hana::tuple<Processors...>>
+  : estd::conjunction<std::integral_constant<bool, isMonoProcessor<Processors, T>>...>
+{
+};
+
+// Processors that aren't groups don't use scratch buffers
+template <class Processor, class = void>
+struct IsProcessorGroup : std::false_type
+{
+};
+
+template <class Processor>
+struct IsProcessorGroup<Processor, std::void_t<decltype(Processor::numScratchBuffers)>>
+  : std::true_type
+{
+};
+
+template <class Processor, class = void>
+struct ScratchBufferCount : std::integral_constant<int, 0>
+{
+};
+
+template <class Processor>
+struct ScratchBufferCount<Processor, std::enable_if_t<IsProcessorGroup<Processor>::value>>
+  : std::integral_constant<int, Processor::numScratchBuffers>
+{
+};
+
 template <class Processors>
+struct MaxScratchBufferCount;
+
+template <class... Processors>
+struct MaxScratchBufferCount<boost::hana::tuple<Processors...>>
+  : std::integral_constant<int, std::max({0, ScratchBufferCount<Processors>::value...})>
+{
+};
+
+template <class Processors>
+struct ProcessorsHotStateSize;
+
+template <class... Processors>
+struct ProcessorsHotStateSize<boost::hana::tuple<Processors...>>
+  : std::integral_constant<std::size_t,
+                           sumSizes({std::size_t(0), Processors::hotStateSize()...})>
+{
+};
+
+} // detail
+
+// True if all of a group's processors take and return single samples of type T
+template <class T, class Processors>
+constexpr bool allMonoProcessors = detail::AllMonoProcessors<T, Processors>::value;
+
+// A view of the scratch buffers that are shared by the groups in a processor tree,
+// each buffer has room for a block of maxBlockSize frames
+template <class T>
+class ScratchBuffers
+{
+  T* data_;
+  int maxBlockSize_;
+
+public:
+  ScratchBuffers(T* data, int maxBlockSize) : data_(data), maxBlockSize_(maxBlockSize) {}
+
+  T* operator[](int index) const { return data_ + index * maxBlockSize_; }
+
+  // The buffers that remain after the first count buffers
+  auto skip(int count) const { return ScratchBuffers{(*this)[count], maxBlockSize_}; }
+};
+
+// The base class for group processors.
+//
+// The scratch buffers needed for block processing are planned at compile time: a group
+// declares the buffers it needs while its processors are running in
+// OwnScratchBuffers, and its processors are free to use any of the buffers after
+// those. Processors in a group never run concurrently, so they can share the same
+// buffers, and the total for a tree is its deepest path rather than its node count.
+// The group at the root of the tree allocates all of the buffers in prepare.
+template <class T, class Processors, int OwnScratchBuffers = 0>
 class ProcessorGroup
 {
 public:
+  static constexpr int numScratchBuffers =
+    OwnScratchBuffers + detail::MaxScratchBufferCount<Processors>::value;
+
   ProcessorGroup(Processors processors) : processors_(processors) { init(); }
 
   void init()
@@ -17,6 +114,35 @@ public:
     boost::hana::for_each(processors_, [](auto& processor) { processor.init(); });
   }
 
+  void prepare(const double sampleRate, const int maxBlockSize)
+  {
+    prepareNested(sampleRate, maxBlockSize);
+    maxBlockSize_ = maxBlockSize;
+    scratch_.assign(numScratchBuffers * maxBlockSize, T(0));
+  }
+
+  // Prepares the group as part of a parent group, which owns the scratch buffers
+  void prepareNested(const double sampleRate, const int maxBlockSize)
+  {
+    boost::hana::for_each(processors_, [=](auto& processor) {
+      prepareProcessor(processor, sampleRate, maxBlockSize,
+                       detail::IsProcessorGroup<std::decay_t<decltype(processor)>>{});
+    });
+  }
+
+  void reset()
+  {
+    boost::hana::for_each(processors_, [](auto& processor) { processor.reset(); });
+  }
+
+  template <class Visitor>
+  void visitState(Visitor& visitor)
+  {
+    boost::hana::for_each(processors_, [&visitor](auto& processor) {
+      processor.visitState(visitor);
+    });
+  }
+
   auto exposedInputs()
   {
     using namespace boost::hana;
@@ -24,8 +150,99 @@ public:
       transform(processors_, [](auto& processor) { return processor.exposedInputs(); }));
   }
 
+  // A group's hot state is its processors' hot state, see footprint.hpp
+  static constexpr std::size_t hotStateSize()
+  {
+    return detail::ProcessorsHotStateSize<Processors>::value;
+  }
+
+  std::size_t heapSize() const
+  {
+    auto size = scratch_.capacity() * sizeof(T);
+    boost::hana::for_each(processors_, [&size](const auto& processor) {
+      size += processor.heapSize();
+    });
+    return size;
+  }
+
+  template <class Visitor>
+  void visitNodes(Visitor&& visit)
+  {
+    boost::hana::for_each(processors_, [&visit](auto& processor) { visit(processor); });
+  }
+
 protected:
+  auto scratch(const int numFrames)
+  {
+    assert(numFrames <= maxBlockSize_);
+    return ScratchBuffers<T>{scratch_.data(), maxBlockSize_};
+  }
+
+  // The scratch buffers that are available to the group's processors
+  static auto processorScratch(const ScratchBuffers<T>& scratch)
+  {
+    return scratch.skip(OwnScratchBuffers);
+  }
+
+  template <class Processor>
+  static bool processNested(Processor& processor,
+                            const T* in,
+                            T* out,
+                            int numFrames,
+                            bool inputIsSilent,
+                            const ScratchBuffers<T>& scratch)
+  {
+    return processNested(processor, in, out, numFrames, inputIsSilent, scratch,
+                         detail::IsProcessorGroup<Processor>{});
+  }
+
   Processors processors_;
+
+private:
+  template <class Processor>
+  static void prepareProcessor(Processor& processor,
+                               double sampleRate,
+                               int maxBlockSize,
+                               std::true_type)
+  {
+    processor.prepareNested(sampleRate, maxBlockSize);
+  }
+
+  template <class Processor>
+  static void prepareProcessor(Processor& processor,
+                               double sampleRate,
+                               int maxBlockSize,
+                               std::false_type)
+  {
+    processor.prepare(sampleRate, maxBlockSize);
+  }
+
+  template <class Processor>
+  static bool processNested(Processor& processor,
+                            const T* in,
+                            T* out,
+                            int numFrames,
+                            bool inputIsSilent,
+                            const ScratchBuffers<T>& scratch,
+                            std::true_type)
+  {
+    return processor.process(in, out, numFrames, inputIsSilent, scratch);
+  }
+
+  template <class Processor>
+  static bool processNested(Processor& processor,
+                            const T* in,
+                            T* out,
+                            int numFrames,
+                            bool inputIsSilent,
+                            const ScratchBuffers<T>&,
+                            std::false_type)
+  {
+    return processor.process(in, out, numFrames, inputIsSilent);
+  }
+
+  std::vector<T> scratch_;
+  int maxBlockSize_ = 0;
 };
 
 } // chains
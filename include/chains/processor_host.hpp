@@ -1,10 +1,18 @@
 #pragma once
 
+#include "chains/bus.hpp"
+#include "chains/footprint.hpp"
+#include "chains/realtime_check.hpp"
 #include "chains/support/can_apply.hpp"
 
 #include <boost/hana/at_key.hpp>
+#include <boost/hana/for_each.hpp>
 #include <boost/hana/tuple.hpp>
 
+#include <algorithm>
+#include <array>
+#include <limits>
+
 namespace chains {
 
 namespace detail {
@@ -15,6 +23,82 @@ using CheckForInit = decltype(std::declval<T>().init());
 template <class T>
 constexpr bool hasInitMethod = canApply<CheckForInit, T>::value;
 
+template <class T>
+using CheckForRebind = decltype(std::declval<T>().rebind());
+
+template <class T>
+constexpr bool hasRebindMethod = canApply<CheckForRebind, T>::value;
+
+template <class T>
+using CheckForPrepare = decltype(std::declval<T>().prepare(0.0, 0));
+
+template <class T>
+constexpr bool hasPrepareMethod = canApply<CheckForPrepare, T>::value;
+
+template <class T>
+using CheckForReset = decltype(std::declval<T>().reset());
+
+template <class T>
+constexpr bool hasResetMethod = canApply<CheckForReset, T>::value;
+
+template <class Processor, class Visitor>
+using CheckForVisitState =
+  decltype(std::declval<Processor&>().visitState(std::declval<Visitor&>()));
+
+template <class Processor, class Visitor>
+constexpr bool hasVisitStateMethod = canApply<CheckForVisitState, Processor, Visitor>::value;
+
+template <class T>
+using CheckForHeapSize = decltype(std::declval<const T>().heapSize());
+
+template <class T>
+constexpr bool hasHeapSizeMethod = canApply<CheckForHeapSize, T>::value;
+
+template <class T>
+using CheckForInputs = decltype(std::declval<T&>().inputs_);
+
+template <class T>
+constexpr bool hasInputs = canApply<CheckForInputs, T>::value;
+
+template <class T>
+using CheckForTailLength = decltype(std::declval<const T>().tailLength());
+
+template <class T>
+constexpr bool hasTailLengthMethod = canApply<CheckForTailLength, T>::value;
+
+template <class T>
+using CheckForLatency = decltype(std::declval<const T>().latency());
+
+template <class T>
+constexpr bool hasLatencyMethod = canApply<CheckForLatency, T>::value;
+
+template <class Processor, class T>
+using CheckForProcess = decltype(std::declval<Processor&>().process(
+  std::declval<const T*>(), std::declval<T*>(), 0));
+
+template <class Processor, class T>
+constexpr bool hasProcessMethod = canApply<CheckForProcess, Processor, T>::value;
+
+template <class Processor, class T, class ChannelCount>
+using CheckForBusProcess = decltype(std::declval<Processor&>().process(
+  std::declval<const Bus<const T, ChannelCount::value>&>(), std::declval<T*>(), 0));
+
+template <class Processor, class T, int Channels>
+constexpr bool hasBusProcessMethod =
+  canApply<CheckForBusProcess, Processor, T, std::integral_constant<int, Channels>>::value;
+
+template <class Processor, class T>
+using CheckForMonoTick = std::enable_if_t<
+  std::is_same<decltype(std::declval<Processor&>().tick(std::declval<const T&>())),
+               T>::value>;
+
+// Processors that mix a planar block of Width channels down to a single sample
+template <class Processor, class T, class Width>
+using CheckForPlanarTick = std::enable_if_t<
+  std::is_same<decltype(std::declval<Processor&>().tick(
+                 std::declval<const std::array<T, Width::value>&>())),
+               T>::value>;
+
 } // detail
 
 // No-op for processors without an init method
@@ -31,24 +115,351 @@ struct InitializeProcessor<Processor, std::enable_if_t<detail::hasInitMethod<Pro
   static void init(Processor& processor) { processor.init(); }
 };
 
+// No-op for processors that don't hold callbacks pointing at themselves
+template <class Processor, class = void>
+struct RebindProcessor
+{
+  static void rebind(Processor&) {}
+};
+
+// Call rebind on processor after it has been copied, if it has a rebind method
+template <class Processor>
+struct RebindProcessor<Processor, std::enable_if_t<detail::hasRebindMethod<Processor>>>
+{
+  static void rebind(Processor& processor) { processor.rebind(); }
+};
+
+// No-op for processors without sample rate dependent state
+template <class Processor, class = void>
+struct PrepareProcessor
+{
+  static void prepare(Processor&, double, int) {}
+};
+
+// Call prepare on processor, if it has a prepare method
+template <class Processor>
+struct PrepareProcessor<Processor,
+                        std::enable_if_t<detail::hasPrepareMethod<Processor>>>
+{
+  static void prepare(Processor& processor, double sampleRate, int maxBlockSize)
+  {
+    processor.prepare(sampleRate, maxBlockSize);
+  }
+};
+
+// No-op for stateless processors
+template <class Processor, class = void>
+struct ResetProcessor
+{
+  static void reset(Processor&) {}
+};
+
+// Call reset on processor, if it has a reset method
+template <class Processor>
+struct ResetProcessor<Processor, std::enable_if_t<detail::hasResetMethod<Processor>>>
+{
+  static void reset(Processor& processor) { processor.reset(); }
+};
+
+// No-op for stateless processors
+template <class Processor, class Visitor, class = void>
+struct VisitProcessorState
+{
+  static void visit(Processor&, Visitor&) {}
+};
+
+// Call visitState on processor, if it has a visitState method
+template <class Processor, class Visitor>
+struct VisitProcessorState<Processor,
+                           Visitor,
+                           std::enable_if_t<detail::hasVisitStateMethod<Processor, Visitor>>>
+{
+  static void visit(Processor& processor, Visitor& visitor) { processor.visitState(visitor); }
+};
+
+// Processes a block by ticking processors that don't have a process method
+template <class Processor, class T, class = void>
+struct ProcessBlock
+{
+  static void process(Processor& processor, const T* in, T* out, int numFrames)
+  {
+    for (auto i = 0; i < numFrames; ++i) {
+      out[i] = processor.tick(in[i]);
+    }
+  }
+};
+
+// Call process on processor, if it has a process method
+template <class Processor, class T>
+struct ProcessBlock<Processor, T, std::enable_if_t<detail::hasProcessMethod<Processor, T>>>
+{
+  static void process(Processor& processor, const T* in, T* out, int numFrames)
+  {
+    processor.process(in, out, numFrames);
+  }
+};
+
+// Processes a multi-channel block by ticking with each frame's samples, for processors
+// that don't process buses
+template <class Processor, class T, int Channels, class = void>
+struct ProcessBus
+{
+  static void process(Processor& processor,
+                      const Bus<const T, Channels>& in,
+                      T* out,
+                      int numFrames)
+  {
+    for (auto i = 0; i < numFrames; ++i) {
+      std::array<T, Channels> frame;
+      for (auto channel = 0; channel < Channels; ++channel) {
+        frame[channel] = in(channel, i);
+      }
+      out[i] = processor.tick(frame);
+    }
+  }
+};
+
+// Call process on processor, if it processes buses in their own layout
+template <class Processor, class T, int Channels>
+struct ProcessBus<Processor,
+                  T,
+                  Channels,
+                  std::enable_if_t<detail::hasBusProcessMethod<Processor, T, Channels>>>
+{
+  static void process(Processor& processor,
+                      const Bus<const T, Channels>& in,
+                      T* out,
+                      int numFrames)
+  {
+    processor.process(in, out, numFrames);
+  }
+};
+
+// The tail length used for processors that don't declare one, e.g. generators
+constexpr int infiniteTailLength = std::numeric_limits<int>::max();
+
+// Processors without a tailLength method are never suspended
+template <class Processor, class = void>
+struct ProcessorTailLength
+{
+  static int tailLength(const Processor&) { return infiniteTailLength; }
+};
+
+// Get the number of frames that the processor keeps producing output after its
+// input becomes silent
+template <class Processor>
+struct ProcessorTailLength<Processor,
+                           std::enable_if_t<detail::hasTailLengthMethod<Processor>>>
+{
+  static int tailLength(const Processor& processor) { return processor.tailLength(); }
+};
+
+// Processors without a latency method don't delay their input
+template <class Processor, class = void>
+struct ProcessorLatency
+{
+  static int latency(const Processor&) { return 0; }
+};
+
+// Get the number of frames by which the processor delays its input
+template <class Processor>
+struct ProcessorLatency<Processor, std::enable_if_t<detail::hasLatencyMethod<Processor>>>
+{
+  static int latency(const Processor& processor) { return processor.latency(); }
+};
+
+// Processors without inputs only hold state
+template <class Processor, class Inputs, class = void>
+struct ProcessorInputs
+{
+  static constexpr std::size_t hotStateSize() { return sizeof(Processor); }
+  static std::size_t heapSize(const Processor&) { return 0; }
+};
+
+// The processor's inputs_ are cold apart from the values that are read while processing
+template <class Processor, class Inputs>
+struct ProcessorInputs<Processor, Inputs, std::enable_if_t<detail::hasInputs<Processor>>>
+{
+  static constexpr std::size_t hotStateSize()
+  {
+    return sizeof(Processor) - sizeof(Inputs) + detail::inputsHotStateSize<Inputs>;
+  }
+
+  static std::size_t heapSize(const Processor& processor)
+  {
+    auto size = std::size_t(0);
+    boost::hana::for_each(boost::hana::values(processor.inputs_),
+                          [&size](const auto& input) { size += input.heapSize(); });
+    return size;
+  }
+};
+
+// Processors without a heapSize method don't allocate
+template <class Processor, class = void>
+struct ProcessorHeapSize
+{
+  static std::size_t heapSize(const Processor&) { return 0; }
+};
+
+// Get the number of bytes that the processor has allocated, if it has a heapSize method
+template <class Processor>
+struct ProcessorHeapSize<Processor,
+                         std::enable_if_t<detail::hasHeapSizeMethod<Processor>>>
+{
+  static std::size_t heapSize(const Processor& processor) { return processor.heapSize(); }
+};
+
+// True if the processor takes and returns single samples of type T
+template <class Processor, class T>
+constexpr bool isMonoProcessor = canApply<detail::CheckForMonoTick, Processor, T>::value;
+
 // A wrapper that provides a standard interface to processors
 template <class Processor, class Inputs, class... Exposed>
 class ProcessorHost
 {
+  // The processor's hot state comes first, followed by the host's cold bookkeeping
   Processor processor_;
+  int silentFrames_ = 0;
+  bool suspended_ = false;
+  const char* name_;
 
 public:
-  ProcessorHost(const Inputs& inputs, const double sampleRate)
-    : processor_(inputs, sampleRate)
+  ProcessorHost(const Inputs& inputs, const double sampleRate, const char* name = "")
+    : processor_(inputs, sampleRate), name_(name)
+  {
+  }
+
+  // Copies take the processor's state as it is, so the potentially expensive init
+  // step is skipped, and any callbacks are rebound to the copy
+  ProcessorHost(const ProcessorHost& other)
+    : processor_(other.processor_)
+    , silentFrames_(other.silentFrames_)
+    , suspended_(other.suspended_)
+    , name_(other.name_)
   {
+    rebind();
+  }
+
+  ProcessorHost(ProcessorHost&& other)
+    : processor_(std::move(other.processor_))
+    , silentFrames_(other.silentFrames_)
+    , suspended_(other.suspended_)
+    , name_(other.name_)
+  {
+    rebind();
+  }
+
+  ProcessorHost& operator=(const ProcessorHost& other)
+  {
+    processor_ = other.processor_;
+    silentFrames_ = other.silentFrames_;
+    suspended_ = other.suspended_;
+    name_ = other.name_;
+    rebind();
+    return *this;
+  }
+
+  ProcessorHost& operator=(ProcessorHost&& other)
+  {
+    processor_ = std::move(other.processor_);
+    silentFrames_ = other.silentFrames_;
+    suspended_ = other.suspended_;
+    name_ = other.name_;
+    rebind();
+    return *this;
   }
 
   template <class T>
-  auto tick(const T& in = T(0))
+  auto tick(const T& in = T(0)) -> decltype(processor_.tick(in))
   {
+    const detail::RealtimeScope scope{name_};
     return processor_.tick(in);
   }
 
+  // Processes a block of samples, in and out may point to the same buffer
+  template <class T>
+  void process(const T* in, T* out, int numFrames)
+  {
+    const detail::RealtimeScope scope{name_};
+    ProcessBlock<Processor, T>::process(processor_, in, out, numFrames);
+  }
+
+  // Processes a block of multi-channel input, for processors that combine channels
+  template <class T, std::size_t Channels>
+  void process(const std::array<const T*, Channels>& in, T* out, int numFrames)
+  {
+    const detail::RealtimeScope scope{name_};
+    processor_.process(in, out, numFrames);
+  }
+
+  // Processes a block of multi-channel input from a bus, in either layout
+  template <class T, int Channels>
+  void process(const Bus<const T, Channels>& in, T* out, int numFrames)
+  {
+    const detail::RealtimeScope scope{name_};
+    ProcessBus<Processor, T, Channels>::process(processor_, in, out, numFrames);
+  }
+
+  template <class T, int Channels>
+  void process(const Bus<T, Channels>& in, T* out, int numFrames)
+  {
+    process(Bus<const T, Channels>{in}, out, numFrames);
+  }
+
+  // Processes a block of samples, skipping the processor once its input has been
+  // silent for longer than its tail. Returns true if the output is silent.
+  template <class T>
+  bool process(const T* in, T* out, int numFrames, bool inputIsSilent)
+  {
+    const detail::RealtimeScope scope{name_};
+    if (inputIsSilent && silentFrames_ >= tailLength()) {
+      // Clear any remaining state so that processing resumes from silence
+      if (!suspended_) {
+        reset();
+        suspended_ = true;
+      }
+
+      std::fill_n(out, numFrames, T(0));
+      return true;
+    }
+
+    suspended_ = false;
+    silentFrames_ =
+      inputIsSilent ? std::min(silentFrames_, infiniteTailLength - numFrames) + numFrames : 0;
+
+    process(in, out, numFrames);
+    return false;
+  }
+
+  int tailLength() const
+  {
+    return ProcessorTailLength<Processor>::tailLength(processor_);
+  }
+
+  int latency() const { return ProcessorLatency<Processor>::latency(processor_); }
+
+  // The module's name from the chain's declaration, or its type's name for unnamed
+  // modules
+  const char* nodeName() const { return name_; }
+
+  // See footprint.hpp
+  static constexpr std::size_t hotStateSize()
+  {
+    return ProcessorInputs<Processor, Inputs>::hotStateSize();
+  }
+
+  std::size_t heapSize() const
+  {
+    return ProcessorHeapSize<Processor>::heapSize(processor_)
+           + ProcessorInputs<Processor, Inputs>::heapSize(processor_);
+  }
+
+  // Modules don't contain other nodes
+  template <class Visitor>
+  void visitNodes(Visitor&&)
+  {
+  }
+
   auto exposedInputs()
   {
     using namespace boost::hana;
@@ -56,6 +467,28 @@ public:
   }
 
   void init() { InitializeProcessor<Processor>::init(processor_); }
+  void rebind() { RebindProcessor<Processor>::rebind(processor_); }
+
+  // Updates sample rate dependent state, and allocates any memory needed for
+  // processing blocks of up to maxBlockSize frames
+  void prepare(const double sampleRate, const int maxBlockSize)
+  {
+    PrepareProcessor<Processor>::prepare(processor_, sampleRate, maxBlockSize);
+  }
+
+  // Clears the processor's state without allocating
+  void reset() { ResetProcessor<Processor>::reset(processor_); }
+
+  // Passes the processor's state to a visitor, followed by the host's silence state and
+  // the values of the exposed inputs, see state.hpp
+  template <class Visitor>
+  void visitState(Visitor& visitor)
+  {
+    VisitProcessorState<Processor, Visitor>::visit(processor_, visitor);
+    visitor(&silentFrames_, 1);
+    visitor(&suspended_, 1);
+    boost::hana::for_each(exposedInputs(), [&visitor](auto* input) { visitor.input(*input); });
+  }
 };
 
 template <class ParameterTraits, class Inputs>
@@ -64,10 +497,23 @@ auto getValue(const Inputs& inputs)
   return inputs[boost::hana::type_c<ParameterTraits>].value();
 }
 
+// True if all samples in the buffer are zero
+template <class T>
+bool isSilent(const T* buffer, int numFrames)
+{
+  return std::all_of(buffer, buffer + numFrames, [](const T& x) { return x == T(0); });
+}
+
 template <class ParameterTraits, class Inputs, class Callback>
 void setCallback(Inputs& inputs, Callback callback)
 {
   return inputs[boost::hana::type_c<ParameterTraits>].setCallback(callback);
 }
 
+template <class ParameterTraits, class Inputs, class Callback>
+void rebindCallback(Inputs& inputs, Callback callback)
+{
+  return inputs[boost::hana::type_c<ParameterTraits>].rebindCallback(callback);
+}
+
 } // chains
@@ -0,0 +1,453 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+
+namespace chains {
+
+namespace realtime {
+
+// A call that isn't safe on a real-time thread, made while processing
+struct Violation
+{
+  // The name of the innermost node that was processing, see Section
+  const char* node;
+  // The function that was called, e.g. "malloc" or "pthread_mutex_lock"
+  const char* call;
+};
+
+using ViolationHandler = void (*)(const Violation&);
+
+namespace detail {
+
+struct ThreadState
+{
+  int depth = 0;
+  const char* node = nullptr;
+  // Set while a violation is being handled, or while checks are suspended
+  bool suspended = false;
+};
+
+inline ThreadState& threadState()
+{
+  static thread_local ThreadState state;
+  return state;
+}
+
+// The default handler prints the violation and aborts, so that violations can't be
+// missed in debug builds
+inline void abortOnViolation(const Violation& violation)
+{
+  std::fprintf(stderr, "Real-time violation: %s called while processing '%s'\n",
+               violation.call, violation.node);
+  std::abort();
+}
+
+inline std::atomic<ViolationHandler>& violationHandler()
+{
+  static std::atomic<ViolationHandler> handler{&abortOnViolation};
+  return handler;
+}
+
+} // detail
+
+// Sets the function that's called when a violation is detected, returning the
+// previous handler. Checks are suspended while the handler runs, so it may allocate.
+inline ViolationHandler setViolationHandler(ViolationHandler handler)
+{
+  return detail::violationHandler().exchange(handler);
+}
+
+// True if the calling thread is in a section and checks aren't suspended
+inline bool isChecking()
+{
+  const auto& state = detail::threadState();
+  return state.depth > 0 && !state.suspended;
+}
+
+// Reports a call that isn't real-time safe if the calling thread is in a section.
+// Called by the interposed functions, see CHAINS_REALTIME_CHECK_IMPLEMENTATION below.
+inline void check(const char* call)
+{
+  if (!isChecking()) {
+    return;
+  }
+
+  auto& state = detail::threadState();
+  state.suspended = true;
+  const auto* node = (state.node && *state.node) ? state.node : "unnamed module";
+  detail::violationHandler().load()(Violation{node, call});
+  state.suspended = false;
+}
+
+// Marks the calling thread as processing the named node for the section's lifetime.
+// Sections nest, with violations reported against the innermost node.
+class Section
+{
+  const char* previousNode_;
+
+public:
+  explicit Section(const char* node) : previousNode_(detail::threadState().node)
+  {
+    auto& state = detail::threadState();
+    ++state.depth;
+    state.node = node;
+  }
+
+  ~Section()
+  {
+    auto& state = detail::threadState();
+    --state.depth;
+    state.node = previousNode_;
+  }
+
+  Section(const Section&) = delete;
+  Section& operator=(const Section&) = delete;
+};
+
+// Suspends checks on the calling thread, e.g. for logging that's known to be unsafe
+class Unchecked
+{
+  bool previous_;
+
+public:
+  Unchecked() : previous_(detail::threadState().suspended)
+  {
+    detail::threadState().suspended = true;
+  }
+
+  ~Unchecked() { detail::threadState().suspended = previous_; }
+
+  Unchecked(const Unchecked&) = delete;
+  Unchecked& operator=(const Unchecked&) = delete;
+};
+
+} // realtime
+
+namespace detail {
+
+// Processor hosts open a section around tick and process when real-time checks are
+// enabled with CHAINS_REALTIME_CHECKS, and otherwise the scope compiles away
+struct NoRealtimeSection
+{
+  explicit NoRealtimeSection(const char*) {}
+};
+
+#ifdef CHAINS_REALTIME_CHECKS
+using RealtimeScope = realtime::Section;
+#else
+using RealtimeScope = NoRealtimeSection;
+#endif
+
+} // detail
+
+} // chains
+
+// The checks are made by interposing the allocation functions and common blocking
+// calls, which needs to be done in a single translation unit of the executable:
+//
+//   #define CHAINS_REALTIME_CHECK_IMPLEMENTATION
+//   #include "chains/realtime_check.hpp"
+//
+// operator new and delete are replaced on all platforms. With glibc the C allocation
+// functions are interposed too, along with stdio writes, sleeping, and mutex locks,
+// which are forwarded to the C library's implementations.
+#ifdef CHAINS_REALTIME_CHECK_IMPLEMENTATION
+
+#include <cerrno>
+#include <new>
+
+#ifdef __GLIBC__
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* pointer);
+}
+
+namespace chains {
+namespace realtime {
+namespace detail {
+
+inline void* allocate(std::size_t size) { return __libc_malloc(size); }
+inline void* allocateAligned(std::size_t alignment, std::size_t size)
+{
+  return __libc_memalign(alignment, size);
+}
+inline void deallocate(void* pointer) { __libc_free(pointer); }
+
+// The functions that are forwarded to the next definition with dlsym, looked up when
+// the program starts so that dlsym isn't called while processing
+struct Forwarded
+{
+  using Write = ssize_t (*)(int, const void*, std::size_t);
+  using Read = ssize_t (*)(int, void*, std::size_t);
+  using FWrite = std::size_t (*)(const void*, std::size_t, std::size_t, FILE*);
+  using FPutC = int (*)(int, FILE*);
+  using FFlush = int (*)(FILE*);
+  using NanoSleep = int (*)(const timespec*, timespec*);
+  using USleep = int (*)(useconds_t);
+  using MutexLock = int (*)(pthread_mutex_t*);
+
+  Write write = Write(dlsym(RTLD_NEXT, "write"));
+  Read read = Read(dlsym(RTLD_NEXT, "read"));
+  FWrite fwrite = FWrite(dlsym(RTLD_NEXT, "fwrite"));
+  FPutC fputc = FPutC(dlsym(RTLD_NEXT, "fputc"));
+  FPutC putc = FPutC(dlsym(RTLD_NEXT, "putc"));
+  FFlush fflush = FFlush(dlsym(RTLD_NEXT, "fflush"));
+  NanoSleep nanosleep = NanoSleep(dlsym(RTLD_NEXT, "nanosleep"));
+  USleep usleep = USleep(dlsym(RTLD_NEXT, "usleep"));
+  MutexLock mutexLock = MutexLock(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+};
+
+inline const Forwarded& forwarded()
+{
+  static const Forwarded functions;
+  return functions;
+}
+
+static const auto& forwardedAtStartup = forwarded();
+
+} // detail
+} // realtime
+} // chains
+
+extern "C" {
+
+void* malloc(std::size_t size) noexcept
+{
+  chains::realtime::check("malloc");
+  return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept
+{
+  chains::realtime::check("calloc");
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, std::size_t size) noexcept
+{
+  chains::realtime::check("realloc");
+  return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) noexcept
+{
+  if (pointer) {
+    chains::realtime::check("free");
+  }
+  __libc_free(pointer);
+}
+
+int posix_memalign(void** pointer, std::size_t alignment, std::size_t size) noexcept
+{
+  chains::realtime::check("posix_memalign");
+  *pointer = __libc_memalign(alignment, size);
+  return *pointer || size == 0 ? 0 : ENOMEM;
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+{
+  chains::realtime::check("aligned_alloc");
+  return __libc_memalign(alignment, size);
+}
+
+ssize_t write(int fd, const void* data, std::size_t size)
+{
+  chains::realtime::check("write");
+  return chains::realtime::detail::forwarded().write(fd, data, size);
+}
+
+ssize_t read(int fd, void* data, std::size_t size)
+{
+  chains::realtime::check("read");
+  return chains::realtime::detail::forwarded().read(fd, data, size);
+}
+
+std::size_t fwrite(const void* data, std::size_t size, std::size_t count, FILE* file)
+{
+  chains::realtime::check("fwrite");
+  return chains::realtime::detail::forwarded().fwrite(data, size, count, file);
+}
+
+int fputc(int c, FILE* file)
+{
+  chains::realtime::check("fputc");
+  return chains::realtime::detail::forwarded().fputc(c, file);
+}
+
+int putc(int c, FILE* file)
+{
+  chains::realtime::check("putc");
+  return chains::realtime::detail::forwarded().putc(c, file);
+}
+
+int fflush(FILE* file)
+{
+  chains::realtime::check("fflush");
+  return chains::realtime::detail::forwarded().fflush(file);
+}
+
+int nanosleep(const timespec* duration, timespec* remaining)
+{
+  chains::realtime::check("nanosleep");
+  return chains::realtime::detail::forwarded().nanosleep(duration, remaining);
+}
+
+int usleep(useconds_t duration)
+{
+  chains::realtime::check("usleep");
+  return chains::realtime::detail::forwarded().usleep(duration);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+{
+  chains::realtime::check("pthread_mutex_lock");
+  return chains::realtime::detail::forwarded().mutexLock(mutex);
+}
+
+} // extern "C"
+
+#else
+
+namespace chains {
+namespace realtime {
+namespace detail {
+
+inline void* allocate(std::size_t size) { return std::malloc(size); }
+inline void* allocateAligned(std::size_t alignment, std::size_t size)
+{
+  return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+inline void deallocate(void* pointer) { std::free(pointer); }
+
+} // detail
+} // realtime
+} // chains
+
+#endif // __GLIBC__
+
+namespace chains {
+namespace realtime {
+namespace detail {
+
+inline void* checkedNew(const std::size_t size, const char* call)
+{
+  check(call);
+  if (auto* pointer = allocate(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+inline void* checkedAlignedNew(const std::size_t size,
+                               const std::align_val_t alignment,
+                               const char* call)
+{
+  check(call);
+  if (auto* pointer = allocateAligned(std::size_t(alignment), size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+inline void checkedDelete(void* pointer, const char* call)
+{
+  if (pointer) {
+    check(call);
+  }
+  deallocate(pointer);
+}
+
+} // detail
+} // realtime
+} // chains
+
+void* operator new(std::size_t size)
+{
+  return chains::realtime::detail::checkedNew(size, "operator new");
+}
+
+void* operator new[](std::size_t size)
+{
+  return chains::realtime::detail::checkedNew(size, "operator new[]");
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  try {
+    return chains::realtime::detail::checkedNew(size, "operator new");
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  try {
+    return chains::realtime::detail::checkedNew(size, "operator new[]");
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+  return chains::realtime::detail::checkedAlignedNew(size, alignment, "operator new");
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+  return chains::realtime::detail::checkedAlignedNew(size, alignment, "operator new[]");
+}
+
+void operator delete(void* pointer) noexcept
+{
+  chains::realtime::detail::checkedDelete(pointer, "operator delete");
+}
+
+void operator delete[](void* pointer) noexcept
+{
+  chains::realtime::detail::checkedDelete(pointer, "operator delete[]");
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+  chains::realtime::detail::checkedDelete(pointer, "operator delete");
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+  chains::realtime::detail::checkedDelete(pointer, "operator delete[]");
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+  chains::realtime::detail::checkedDelete(pointer, "operator delete");
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+  chains::realtime::detail::checkedDelete(pointer, "operator delete[]");
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+  chains::realtime::detail::checkedDelete(pointer, "operator delete");
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+  chains::realtime::detail::checkedDelete(pointer, "operator delete[]");
+}
+
+#endif // CHAINS_REALTIME_CHECK_IMPLEMENTATION
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "chains/clone.hpp"
+#include "chains/io/audio_file.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace chains {
+
+struct RenderStats
+{
+  std::int64_t numFrames = 0;
+  int numChannels = 0;
+  double sampleRate = 0.0;
+  double seconds = 0.0;
+
+  double samplesPerSecond() const
+  {
+    return seconds > 0.0 ? double(numFrames) * numChannels / seconds : 0.0;
+  }
+
+  // The rendered audio's duration divided by the time taken to render it
+  double realtimeFactor() const
+  {
+    return seconds > 0.0 ? double(numFrames) / sampleRate / seconds : 0.0;
+  }
+};
+
+// Renders a file through a chain, offline.
+//
+// Each block of blockSize frames is converted from the input's interleaved frames in a
+// single pass, and then each of its channels is processed by its own clone of the
+// prototype processor. All buffers are allocated before rendering
+// starts, so the render loop itself doesn't allocate.
+template <class T, class Processor>
+RenderStats render(const Processor& prototype,
+                   const io::AudioFileReader& input,
+                   io::WavFileWriter& output,
+                   const int blockSize = 1024)
+{
+  const auto& format = input.format();
+  const auto numChannels = format.numChannels;
+
+  auto processors = makeClones(prototype, numChannels);
+  for (auto& processor : processors) {
+    processor.prepare(format.sampleRate, blockSize);
+    processor.reset();
+  }
+
+  std::vector<T> buffer(std::size_t(numChannels) * blockSize);
+  std::vector<T*> channels(numChannels);
+  for (auto channel = 0; channel < numChannels; ++channel) {
+    channels[channel] = &buffer[std::size_t(channel) * blockSize];
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (std::int64_t frame = 0; frame < input.numFrames(); frame += blockSize) {
+    const auto numFrames = int(std::min<std::int64_t>(blockSize, input.numFrames() - frame));
+    input.read(frame, numFrames, channels.data());
+    for (auto channel = 0; channel < numChannels; ++channel) {
+      processors[channel].process(channels[channel], channels[channel], numFrames);
+    }
+    output.write(channels.data(), numFrames);
+  }
+
+  RenderStats stats;
+  stats.numFrames = input.numFrames();
+  stats.numChannels = numChannels;
+  stats.sampleRate = format.sampleRate;
+  stats.seconds =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+
+} // chains
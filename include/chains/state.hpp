@@ -0,0 +1,232 @@
+#pragma once
+
+#include "chains/io/audio_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace chains {
+
+// Processors describe their state with a visitState method, which passes each
+// contiguous run of trivially copyable state to a visitor as visit(pointer, count),
+// always in the same order. Hosts also pass their exposed inputs as visit.input(input),
+// so that inputs with callbacks are updated when their values are restored.
+//
+// The order and types of the runs are fixed at compile time and their sizes are fixed
+// once a processor has been prepared, so a snapshot is a sequence of copies with no
+// per-field headers, and can only be restored into a processor made from the same
+// chain.
+
+namespace detail {
+
+// FNV-1a, used to check that a snapshot's layout matches the processor it's restored to
+inline std::uint64_t hashLayout(std::uint64_t hash, const std::uint64_t value)
+{
+  for (auto byte = 0; byte < 8; ++byte) {
+    hash ^= (value >> (byte * 8)) & 0xff;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Distinguishes runs of values that have the same size but different types, e.g.
+// float and std::int32_t. The tag only depends on the type's traits so that it's the
+// same in every build.
+template <class Value>
+constexpr std::uint64_t stateTypeTag()
+{
+  return (std::is_floating_point<Value>::value ? 1 : 0)
+         | (std::is_signed<Value>::value ? 2 : 0) | (std::is_class<Value>::value ? 4 : 0)
+         | (std::is_pointer<Value>::value ? 8 : 0);
+}
+
+struct StateLayout
+{
+  std::uint64_t size = 0;
+  std::uint64_t hash = 14695981039346656037ull;
+
+  template <class Value>
+  void operator()(Value*, const std::size_t count)
+  {
+    static_assert(std::is_trivially_copyable<Value>::value, "State must be copyable");
+    size += count * sizeof(Value);
+    hash = hashLayout(hash, stateTypeTag<Value>());
+    hash = hashLayout(hashLayout(hash, sizeof(Value)), count);
+  }
+
+  template <class Input>
+  void input(Input&)
+  {
+    (*this)(static_cast<double*>(nullptr), 1);
+  }
+};
+
+struct StateWriter
+{
+  std::uint8_t* data;
+
+  template <class Value>
+  void operator()(const Value* values, const std::size_t count)
+  {
+    std::memcpy(data, values, count * sizeof(Value));
+    data += count * sizeof(Value);
+  }
+
+  template <class Input>
+  void input(Input& input)
+  {
+    const auto value = input.value();
+    (*this)(&value, 1);
+  }
+};
+
+struct StateReader
+{
+  const std::uint8_t* data;
+
+  template <class Value>
+  void operator()(Value* values, const std::size_t count)
+  {
+    std::memcpy(values, data, count * sizeof(Value));
+    data += count * sizeof(Value);
+  }
+
+  template <class Input>
+  void input(Input& input)
+  {
+    auto value = 0.0;
+    (*this)(&value, 1);
+    input.setValue(value);
+  }
+};
+
+template <class Processor>
+StateLayout stateLayout(Processor& processor)
+{
+  StateLayout layout;
+  processor.visitState(layout);
+  return layout;
+}
+
+} // detail
+
+// The header at the start of each snapshot
+struct SnapshotHeader
+{
+  static constexpr std::uint32_t expectedMagic = 0x53534843; // "CHSS"
+  static constexpr std::uint32_t currentVersion = 2;
+
+  std::uint32_t magic = expectedMagic;
+  std::uint32_t version = currentVersion;
+  // The size of the state that follows the header, in bytes
+  std::uint64_t size = 0;
+  std::uint64_t layoutHash = 0;
+};
+
+// The size of a processor's snapshot in bytes, including the header
+template <class Processor>
+std::size_t snapshotSize(Processor& processor)
+{
+  return sizeof(SnapshotHeader) + std::size_t(detail::stateLayout(processor).size);
+}
+
+// Writes a snapshot of a prepared processor's state to data, which needs room for
+// snapshotSize bytes
+template <class Processor>
+void writeSnapshot(Processor& processor, void* data)
+{
+  const auto layout = detail::stateLayout(processor);
+
+  SnapshotHeader header;
+  header.size = layout.size;
+  header.layoutHash = layout.hash;
+  std::memcpy(data, &header, sizeof(header));
+
+  detail::StateWriter writer{static_cast<std::uint8_t*>(data) + sizeof(header)};
+  processor.visitState(writer);
+}
+
+template <class Processor>
+std::vector<std::uint8_t> snapshot(Processor& processor)
+{
+  std::vector<std::uint8_t> data(snapshotSize(processor));
+  writeSnapshot(processor, data.data());
+  return data;
+}
+
+// Restores a snapshot into a prepared processor that was made from the same chain.
+// Returns false, leaving the processor unchanged, if the snapshot doesn't match the
+// processor's layout.
+template <class Processor>
+bool restoreSnapshot(Processor& processor, const void* data, const std::size_t size)
+{
+  if (size < sizeof(SnapshotHeader)) {
+    return false;
+  }
+
+  SnapshotHeader header;
+  std::memcpy(&header, data, sizeof(header));
+
+  const auto layout = detail::stateLayout(processor);
+  if (header.magic != SnapshotHeader::expectedMagic
+      || header.version != SnapshotHeader::currentVersion || header.size != layout.size
+      || header.layoutHash != layout.hash || size - sizeof(header) < layout.size) {
+    return false;
+  }
+
+  detail::StateReader reader{static_cast<const std::uint8_t*>(data) + sizeof(header)};
+  processor.visitState(reader);
+  return true;
+}
+
+template <class Processor>
+bool restoreSnapshot(Processor& processor, const std::vector<std::uint8_t>& data)
+{
+  return restoreSnapshot(processor, data.data(), data.size());
+}
+
+// Writes a snapshot directly into a memory-mapped file. Returns false if the file
+// couldn't be created.
+template <class Processor>
+bool saveSnapshotFile(Processor& processor, const std::string& path)
+{
+  const auto size = snapshotSize(processor);
+
+  const auto file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file < 0) {
+    return false;
+  }
+  if (::ftruncate(file, off_t(size)) != 0) {
+    ::close(file);
+    return false;
+  }
+
+  auto* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  ::close(file);
+  if (data == MAP_FAILED) {
+    return false;
+  }
+
+  writeSnapshot(processor, data);
+  ::munmap(data, size);
+  return true;
+}
+
+// Restores a snapshot from a memory-mapped file, copying the state straight out of the
+// mapping. Returns false if the file couldn't be mapped or doesn't match the processor.
+template <class Processor>
+bool loadSnapshotFile(Processor& processor, const std::string& path)
+{
+  io::MappedFile file;
+  return file.open(path) && restoreSnapshot(processor, file.data(), file.size());
+}
+
+} // chains
@@ -0,0 +1,84 @@
+#include "chains/dynamic/chain.hpp"
+#include "chains/groups/serial.hpp"
+#include "chains/groups/split.hpp"
+#include "chains/module.hpp"
+#include "chains/modules/biquad.hpp"
+#include "chains/modules/crossfade.hpp"
+#include "chains/modules/delay.hpp"
+#include "chains/modules/gain.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Compares a chain that's declared at compile time with the same chain loaded from a
+// patch at runtime, at a range of block sizes.
+
+namespace {
+
+const double sampleRate = 48e3;
+const int numFrames = 1 << 20;
+
+const char* const patch = R"(
+  serial(biquad(frequency = 2000),
+         biquad(frequency = 500),
+         split(gain(gain = 0.5), delay(length = 10)),
+         crossfade(fade = 0.3),
+         gain(gain = 0.9))
+)";
+
+// The time taken to process numFrames frames, in nanoseconds per frame
+template <class Processor>
+double nanosecondsPerFrame(Processor& processor, std::vector<float>& buffer, int blockSize)
+{
+  processor.prepare(sampleRate, blockSize);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (auto frame = 0; frame + blockSize <= numFrames; frame += blockSize) {
+    processor.process(buffer.data() + frame, buffer.data() + frame, blockSize);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / numFrames;
+}
+
+} // namespace
+
+int main()
+{
+  using namespace chains;
+
+  const auto chain =
+    serial(module<Biquad>(Value<biquad::Frequency>(2000.0)),
+           module<Biquad>(Value<biquad::Frequency>(500.0)),
+           split(module<Gain>(Value<gain::Gain>(0.5)), module<Delay>(Value<delay::Length>(10))),
+           module<Crossfade>(Value<crossfade::Fade>(0.3)),
+           module<Gain>(Value<gain::Gain>(0.9)));
+  auto compiled = chain.makeProcessor<float>(sampleRate);
+
+  DynamicChain<float> dynamic;
+  if (!dynamic.load(patch, sampleRate)) {
+    std::fprintf(stderr, "Invalid patch: %s\n", dynamic.error().c_str());
+    return 1;
+  }
+
+  std::vector<float> buffer(numFrames);
+  auto seed = 1u;
+  for (auto& sample : buffer) {
+    seed = seed * 1664525u + 1013904223u;
+    sample = float(seed >> 8) / float(1 << 24) - 0.5f;
+  }
+
+  std::printf("%8s %14s %14s %10s\n", "block", "compiled ns", "dynamic ns", "overhead");
+  for (auto blockSize = 16; blockSize <= 1024; blockSize *= 2) {
+    // Each run processes its own copy of the input
+    auto compiledBuffer = buffer;
+    auto dynamicBuffer = buffer;
+    const auto compiledTime = nanosecondsPerFrame(compiled, compiledBuffer, blockSize);
+    const auto dynamicTime = nanosecondsPerFrame(dynamic, dynamicBuffer, blockSize);
+
+    std::printf("%8d %14.2f %14.2f %9.1f%%\n", blockSize, compiledTime, dynamicTime,
+                (dynamicTime / compiledTime - 1.0) * 100.0);
+  }
+
+  return 0;
+}
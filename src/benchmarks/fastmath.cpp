@@ -0,0 +1,98 @@
+#include "chains/dsp/fastmath.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+namespace fastmath = dsp::fastmath;
+
+const int numValues = 1 << 16;
+const int numRepeats = 200;
+
+template <class Function>
+double nanosecondsPerValue(Function function)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (auto i = 0; i < numRepeats; ++i) {
+    function();
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count()
+         / (double(numValues) * numRepeats);
+}
+
+template <class T>
+void benchmark(const char* typeName)
+{
+  std::vector<T> in(numValues);
+  std::vector<T> exponents(numValues, T(1.5));
+  std::vector<T> out(numValues);
+  std::vector<T> expected(numValues);
+
+  struct Function
+  {
+    const char* name;
+    double minimum;
+    double maximum;
+    void (*exact)(const T*, const T*, T*, int);
+    void (*precise)(const T*, const T*, T*, int);
+    void (*fast)(const T*, const T*, T*, int);
+  };
+
+  const Function functions[] = {
+    {"sin", -M_PI, M_PI,
+     [](const T* x, const T*, T* out, int n) { fastmath::sin<fastmath::Exact>(x, out, n); },
+     [](const T* x, const T*, T* out, int n) { fastmath::sin<fastmath::Precise>(x, out, n); },
+     [](const T* x, const T*, T* out, int n) { fastmath::sin<fastmath::Fast>(x, out, n); }},
+    {"tan", -1.5, 1.5,
+     [](const T* x, const T*, T* out, int n) { fastmath::tan<fastmath::Exact>(x, out, n); },
+     [](const T* x, const T*, T* out, int n) { fastmath::tan<fastmath::Precise>(x, out, n); },
+     [](const T* x, const T*, T* out, int n) { fastmath::tan<fastmath::Fast>(x, out, n); }},
+    {"exp", -20.0, 20.0,
+     [](const T* x, const T*, T* out, int n) { fastmath::exp<fastmath::Exact>(x, out, n); },
+     [](const T* x, const T*, T* out, int n) { fastmath::exp<fastmath::Precise>(x, out, n); },
+     [](const T* x, const T*, T* out, int n) { fastmath::exp<fastmath::Fast>(x, out, n); }},
+    {"pow", 1e-3, 20.0,
+     [](const T* x, const T* y, T* out, int n) { fastmath::pow<fastmath::Exact>(x, y, out, n); },
+     [](const T* x, const T* y, T* out, int n) { fastmath::pow<fastmath::Precise>(x, y, out, n); },
+     [](const T* x, const T* y, T* out, int n) { fastmath::pow<fastmath::Fast>(x, y, out, n); }},
+  };
+
+  for (const auto& function : functions) {
+    for (auto i = 0; i < numValues; ++i) {
+      in[i] = T(function.minimum + (function.maximum - function.minimum) * i / numValues);
+    }
+
+    function.exact(in.data(), exponents.data(), expected.data(), numValues);
+
+    const auto run = [&](const char* accuracy, auto process) {
+      const auto time = nanosecondsPerValue(
+        [&] { process(in.data(), exponents.data(), out.data(), numValues); });
+
+      auto maxError = 0.0;
+      for (auto i = 0; i < numValues; ++i) {
+        const auto scale = std::max(std::abs(double(expected[i])), 1.0);
+        maxError = std::max(maxError, std::abs(double(out[i] - expected[i])) / scale);
+      }
+
+      std::printf("%-7s %-4s %-8s %8.3f ns  max error %.3g\n", typeName, function.name,
+                  accuracy, time, maxError);
+    };
+
+    run("exact", function.exact);
+    run("precise", function.precise);
+    run("fast", function.fast);
+  }
+}
+
+} // namespace
+
+int main()
+{
+  benchmark<float>("float");
+  benchmark<double>("double");
+}
@@ -0,0 +1,110 @@
+#include "chains/dsp/fixed_point.hpp"
+#include "chains/groups/serial.hpp"
+#include "chains/groups/split.hpp"
+#include "chains/module.hpp"
+#include "chains/modules/biquad.hpp"
+#include "chains/modules/crossfade.hpp"
+#include "chains/modules/delay.hpp"
+#include "chains/modules/gain.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Compares the speed and accuracy of a chain processed with each sample type, against
+// the same chain processed with doubles.
+
+namespace {
+
+const double sampleRate = 48e3;
+const int numFrames = 1 << 20;
+const int blockSize = 128;
+
+struct Result
+{
+  double nanosecondsPerFrame;
+  std::vector<double> output;
+};
+
+template <class T, class Chain>
+Result run(const Chain& chain, const std::vector<double>& input)
+{
+  auto processor = chain.template makeProcessor<T>(sampleRate);
+  processor.prepare(sampleRate, blockSize);
+
+  std::vector<T> buffer(numFrames);
+  std::transform(input.begin(), input.end(), buffer.begin(),
+                 [](double x) { return T(x); });
+
+  const auto start = std::chrono::steady_clock::now();
+  for (auto frame = 0; frame + blockSize <= numFrames; frame += blockSize) {
+    processor.process(buffer.data() + frame, buffer.data() + frame, blockSize);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  Result result;
+  result.nanosecondsPerFrame =
+    std::chrono::duration<double, std::nano>(elapsed).count() / numFrames;
+  result.output.resize(numFrames);
+  std::transform(buffer.begin(), buffer.end(), result.output.begin(),
+                 [](T x) { return double(x); });
+  return result;
+}
+
+template <class T, class Chain>
+void report(const char* name, const Chain& chain, const std::vector<double>& input,
+            const Result& reference)
+{
+  const auto result = run<T>(chain, input);
+
+  auto maxError = 0.0;
+  auto signal = 0.0;
+  auto noise = 0.0;
+  for (auto i = 0; i < numFrames; ++i) {
+    const auto error = result.output[i] - reference.output[i];
+    maxError = std::max(maxError, std::abs(error));
+    signal += reference.output[i] * reference.output[i];
+    noise += error * error;
+  }
+  const auto snr = noise > 0.0 ? 10.0 * std::log10(signal / noise) : INFINITY;
+
+  std::printf("%8s %10.2f %14.3g %10.1f\n", name, result.nanosecondsPerFrame, maxError,
+              snr);
+}
+
+} // namespace
+
+int main()
+{
+  using namespace chains;
+
+  const auto chain =
+    serial(module<Gain>(Value<gain::Gain>(0.8)),
+           module<Biquad>(Value<biquad::Frequency>(2000.0), Value<biquad::Q>(0.707)),
+           module<Biquad>(Value<biquad::Frequency>(500.0), Value<biquad::Q>(0.707),
+                          Value<biquad::Type>(2.0)),
+           split(module<Gain>(Value<gain::Gain>(0.5)),
+                 module<Delay>(Value<delay::Length>(10))),
+           module<Crossfade>(Value<crossfade::Fade>(0.3), Value<crossfade::Curve>(1.0)),
+           module<Gain>(Value<gain::Gain>(1.5)));
+
+  std::vector<double> input(numFrames);
+  auto seed = 1u;
+  for (auto& sample : input) {
+    seed = seed * 1664525u + 1013904223u;
+    sample = double(seed >> 8) / double(1 << 24) - 0.5;
+  }
+
+  const auto reference = run<double>(chain, input);
+
+  std::printf("%8s %10s %14s %10s\n", "type", "ns/frame", "max error", "SNR dB");
+  std::printf("%8s %10.2f %14s %10s\n", "double", reference.nanosecondsPerFrame, "-",
+              "-");
+  report<float>("float", chain, input, reference);
+  report<dsp::Q31>("Q31", chain, input, reference);
+  report<dsp::Q15>("Q15", chain, input, reference);
+
+  return 0;
+}
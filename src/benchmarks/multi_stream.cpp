@@ -0,0 +1,78 @@
+#include "chains/engine/multi_stream_engine.hpp"
+#include "chains/groups/serial.hpp"
+#include "chains/module.hpp"
+#include "chains/modules/biquad.hpp"
+#include "chains/modules/gain.hpp"
+#include "chains/modules/phasor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Measures how the multi-stream engine scales with the number of workers, from one
+// worker up to the number of cores, or 64 at most.
+
+namespace {
+
+const int numStreams = 4096;
+const int numBlocks = 100;
+
+} // namespace
+
+int main()
+{
+  using namespace chains;
+
+  const auto chain = serial(module<Phasor>(Value<phasor::Frequency>(440.0)),
+                            module<Biquad>(Value<biquad::Frequency>(2000.0)),
+                            module<Biquad>(Value<biquad::Frequency>(500.0)),
+                            module<Gain>(Value<gain::Gain>(0.5)));
+  auto prototype = chain.makeProcessor<float>(48e3);
+  using Engine = MultiStreamEngine<float, decltype(prototype)>;
+
+  const auto maxWorkers = std::min(64, int(std::max(1u, std::thread::hardware_concurrency())));
+
+  std::printf("%d streams, %d blocks\n", numStreams, numBlocks);
+  std::printf("%8s %14s %10s %10s %10s\n", "workers", "us per block", "speedup", "misses",
+              "steals");
+
+  // Powers of two, followed by the number of cores if it isn't one
+  std::vector<int> workerCounts;
+  for (auto numWorkers = 1; numWorkers < maxWorkers; numWorkers *= 2) {
+    workerCounts.push_back(numWorkers);
+  }
+  workerCounts.push_back(maxWorkers);
+
+  auto singleWorkerTime = 0.0;
+  for (const auto numWorkers : workerCounts) {
+    Engine::Options options;
+    options.numWorkers = numWorkers;
+    options.blockSize = 256;
+    Engine engine(prototype, numStreams, options);
+
+    // A block to warm up the caches
+    engine.process();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < numBlocks; ++i) {
+      engine.process();
+    }
+    const auto elapsed = std::chrono::duration<double, std::micro>(
+                           std::chrono::steady_clock::now() - start)
+                           .count()
+                         / numBlocks;
+
+    if (numWorkers == 1) {
+      singleWorkerTime = elapsed;
+    }
+
+    std::printf("%8d %14.1f %10.2f %10lld %10lld\n", numWorkers, elapsed,
+                singleWorkerTime / elapsed,
+                static_cast<long long>(engine.totalDeadlineMisses()),
+                static_cast<long long>(engine.numSteals()));
+  }
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include "chains/clone.hpp"
+#include "chains/engine/realtime_engine.hpp"
+#include "chains/groups/serial.hpp"
+#include "chains/module.hpp"
+#include "chains/modules/biquad.hpp"
+#include "chains/modules/gain.hpp"
+
+#include <cstdio>
+#include <vector>
+
+// Finds how many copies of a chain can run in series on one core, under the real-time
+// engine, before callbacks start missing their deadlines. A few xruns are allowed for
+// scheduling hiccups that aren't caused by the processing load.
+
+namespace {
+
+const int blockSize = 128;
+const double sampleRate = 48e3;
+const int numBlocks = 2000;
+const int allowedXruns = numBlocks / 500;
+const int maxCopies = 1 << 16;
+
+// Runs a number of copies of a processor in series
+template <class Processor>
+struct Repeated
+{
+  std::vector<Processor> processors;
+
+  void prepare(double sampleRate, int maxBlockSize)
+  {
+    for (auto& processor : processors) {
+      processor.prepare(sampleRate, maxBlockSize);
+    }
+  }
+
+  void process(const float* in, float* out, int numFrames)
+  {
+    for (auto& processor : processors) {
+      processor.process(in, out, numFrames);
+      in = out;
+    }
+  }
+};
+
+} // namespace
+
+int main()
+{
+  using namespace chains;
+
+  const auto chain = serial(module<Biquad>(Value<biquad::Frequency>(2000.0)),
+                            module<Biquad>(Value<biquad::Frequency>(500.0)),
+                            module<Gain>(Value<gain::Gain>(0.9)));
+  auto prototype = chain.makeProcessor<float>(sampleRate);
+
+  std::printf("%8s %10s %10s %12s %12s %5s\n", "copies", "mean load", "max load", "max jitter",
+              "xruns", "fifo");
+
+  const auto period = blockSize / sampleRate;
+  for (auto copies = 1; copies <= maxCopies; copies *= 2) {
+    Repeated<decltype(prototype)> repeated{makeClones(prototype, copies)};
+
+    using Engine = RealtimeEngine<float, decltype(repeated)>;
+    Engine::Options options;
+    options.blockSize = blockSize;
+    options.sampleRate = sampleRate;
+    options.core = 0;
+    Engine engine(repeated, options);
+    engine.runFor(numBlocks);
+
+    const auto& stats = engine.stats();
+    std::printf("%8d %9.1f%% %9.1f%% %10.1fus %12lld %5s\n", copies,
+                stats.meanCallbackTime() / period * 100.0,
+                stats.maxCallbackTime / period * 100.0, stats.maxJitter * 1e6,
+                static_cast<long long>(stats.numXruns), stats.realtimePriority ? "yes" : "no");
+
+    if (stats.numXruns > allowedXruns) {
+      break;
+    }
+  }
+
+  return 0;
+}
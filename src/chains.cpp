@@ -1,18 +1,102 @@
+#include "chains/bus.hpp"
+#include "chains/clone.hpp"
+#include "chains/dsp/fastmath.hpp"
+#include "chains/dsp/fixed_point.hpp"
+#include "chains/dsp/fft.hpp"
+#include "chains/dynamic/chain.hpp"
+#include "chains/footprint.hpp"
+#include "chains/engine/multi_stream_engine.hpp"
+#include "chains/engine/realtime_engine.hpp"
+#include "chains/engine/swap_slot.hpp"
+#include "chains/groups/multi_channel.hpp"
 #include "chains/groups/parallel.hpp"
+#include "chains/groups/pipeline.hpp"
+#include "chains/groups/precision.hpp"
 #include "chains/groups/recursive.hpp"
 #include "chains/groups/serial.hpp"
+#include "chains/groups/spectral.hpp"
 #include "chains/groups/split.hpp"
 #include "chains/modules/accumulator.hpp"
+#include "chains/modules/biquad.hpp"
+#include "chains/modules/convolver.hpp"
 #include "chains/modules/crossfade.hpp"
 #include "chains/modules/delay.hpp"
 #include "chains/modules/gain.hpp"
+#include "chains/modules/multi_tap_delay.hpp"
 #include "chains/modules/ones.hpp"
 #include "chains/modules/phasor.hpp"
 #include "chains/modules/probe.hpp"
 #include "chains/modules/wire.hpp"
+#include "chains/modulation.hpp"
+#include "chains/parameter_set.hpp"
+#include "chains/render.hpp"
+#include "chains/state.hpp"
 
 #include <catch/single_include/catch.hpp>
 
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <thread>
+
+
+namespace {
+
+// A decaying noise impulse response for testing convolution
+std::vector<double> testImpulseResponse(int length)
+{
+  std::vector<double> samples(length);
+  auto seed = 1u;
+  for (auto i = 0; i < length; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    samples[i] = (double(seed >> 8) / double(1 << 24) - 0.5) * std::exp(-i / 200.0);
+  }
+  return samples;
+}
+
+struct TestRoom : chains::convolver::ImpulseResponse
+{
+  static int partitionSize() { return 32; }
+  static auto samples() { return testImpulseResponse(1000); }
+};
+
+struct TestCabinet : chains::convolver::ImpulseResponse
+{
+  static int partitionSize() { return 16; }
+  static bool zeroLatency() { return false; }
+  static auto samples() { return testImpulseResponse(100); }
+};
+
+// Silences the bins of a spectrum with magnitudes below the threshold
+namespace spectral_gate {
+
+struct Threshold
+{
+  static auto name() { return "Threshold"; }
+  static auto defaultValue() { return 1.0; }
+};
+
+struct Module
+{
+  using Parameters = chains::ParameterTraits<Threshold>;
+
+  template <class T, class Inputs>
+  struct Processor
+  {
+    Processor(const Inputs& inputs, double /* sampleRate */) : inputs_(inputs) {}
+
+    auto tick(const T& in)
+    {
+      return std::abs(in) < chains::getValue<Threshold>(inputs_) ? T(0) : in;
+    }
+
+    Inputs inputs_;
+  };
+};
+
+} // spectral_gate
+
+} // namespace
 
 TEST_CASE("Wrapper")
 {
@@ -174,6 +258,1583 @@ TEST_CASE("Wrapper")
     CHECK(processor.tick(0.0) == 0.0);
   }
 
+  SECTION("Clone")
+  {
+    const auto chain = serial(module<Phasor, Expose<phasor::Frequency>>(),
+                              module<Biquad>(Value<biquad::Frequency>{100.0},
+                                             Value<biquad::Q>{0.7}));
+
+    auto prototype = chain.makeProcessor<double>(48e3);
+    auto reference = chain.makeProcessor<double>(48e3);
+
+    auto clones = makeClones(prototype, 3);
+    REQUIRE(clones.size() == 3);
+
+    // The clones' callbacks must update the clones, not the prototype
+    hana::at_c<0>(clones[1].exposedInputs())->setValue(1000);
+    hana::at_c<0>(reference.exposedInputs())->setValue(1000);
+
+    for (auto i = 0; i < 8; ++i) {
+      const auto expected = reference.tick();
+      CHECK(clones[1].tick() == expected);
+      CHECK(clones[0].tick() == prototype.tick());
+    }
+
+    // The untouched clone starts from the prototype's initial state
+    CHECK(clones[2].tick() == chain.makeProcessor<double>(48e3).tick());
+  }
+
+  SECTION("Prepare and reset")
+  {
+    const auto chain = serial(module<Phasor, Expose<phasor::Frequency>>(),
+                              module<Delay>(Value<delay::Length>{1}));
+
+    auto processor = chain.makeProcessor<double>(4);
+
+    CHECK(processor.tick() == 0.0);
+    CHECK(processor.tick() == 0.25);
+    CHECK(processor.tick() == 0.5);
+
+    processor.prepare(8, 64);
+    processor.reset();
+
+    CHECK(processor.tick() == 0.0);
+    CHECK(processor.tick() == 0.125);
+    CHECK(processor.tick() == 0.25);
+
+    // Exposed frequency changes still take the new sample rate into account
+    hana::at_c<0>(processor.exposedInputs())->setValue(2);
+    CHECK(processor.tick() == 0.375);
+    CHECK(processor.tick() == 0.625);
+  }
+
+  SECTION("Block processing")
+  {
+    const auto chain = serial(
+      module<Accumulator>(Value<accumulator::Wrap>{4}),
+      parallel(module<Gain>(Value<gain::Gain>{0.5}), module<Delay>(Value<delay::Length>{2})),
+      recursive(module<Gain>(Value<gain::Gain>{1}), module<Gain>(Value<gain::Gain>{0.5})),
+      serial(split(module<Gain>(Value<gain::Gain>(1)), module<Gain>(Value<gain::Gain>(2))),
+             module<Crossfade>(Value<crossfade::Fade>(0.25))));
+
+    auto reference = chain.makeProcessor<double>(48e3);
+    auto processor = chain.makeProcessor<double>(48e3);
+    processor.prepare(48e3, 8);
+
+    std::array<double, 8> block{};
+    for (auto n = 0; n < 4; ++n) {
+      for (auto i = 0; i < 8; ++i) {
+        block[i] = 0.25 * (i + n);
+      }
+
+      const auto numFrames = 8 - n;
+      processor.process(block.data(), block.data(), numFrames);
+
+      for (auto i = 0; i < numFrames; ++i) {
+        CHECK(block[i] == reference.tick(0.25 * (i + n)));
+      }
+    }
+  }
+
+  SECTION("Silence")
+  {
+    const auto chain =
+      parallel(serial(module<Delay>(Value<delay::Length>{3}), module<Gain>()),
+               module<Biquad>(Value<biquad::Frequency>{1000}, Value<biquad::Q>{0.7}),
+               serial(module<Ones>(), module<Gain>(Value<gain::Gain>{0.0})));
+
+    auto reference = chain.makeProcessor<double>(48e3);
+    auto processor = chain.makeProcessor<double>(48e3);
+    processor.prepare(48e3, 4);
+
+    auto biquad =
+      module<Biquad>(Value<biquad::Frequency>{1000}, Value<biquad::Q>{0.7})
+        .makeProcessor<double>(48e3);
+    biquad.init();
+    const auto biquadTail = biquad.tailLength();
+    REQUIRE(biquadTail > 3);
+    REQUIRE(biquadTail < 1000);
+
+    const auto checkBlock = [&](const std::array<double, 4>& input) {
+      auto block = input;
+      const auto silent =
+        processor.process(block.data(), block.data(), 4, isSilent(block.data(), 4));
+      for (auto i = 0; i < 4; ++i) {
+        CHECK(block[i] == Approx(reference.tick(input[i])).margin(1e-4));
+      }
+      return silent;
+    };
+
+    // The generator branch is never silent, so the group isn't either
+    CHECK_FALSE(checkBlock({{1.0, 0.5, 0.25, 0.0}}));
+    for (auto i = 0; i < biquadTail / 4 + 2; ++i) {
+      CHECK_FALSE(checkBlock({{0.0, 0.0, 0.0, 0.0}}));
+    }
+    CHECK_FALSE(checkBlock({{0.25, 0.0, 0.0, 0.0}}));
+    CHECK_FALSE(checkBlock({{0.0, 0.0, 0.0, 0.0}}));
+
+    // Without the generator, the group's output becomes silent after the longest tail
+    const auto filters =
+      parallel(serial(module<Delay>(Value<delay::Length>{3}), module<Gain>()),
+               module<Biquad>(Value<biquad::Frequency>{1000}, Value<biquad::Q>{0.7}));
+    auto filterProcessor = filters.makeProcessor<double>(48e3);
+    filterProcessor.prepare(48e3, 4);
+
+    std::array<double, 4> block{{1.0, 0.0, 0.0, 0.0}};
+    CHECK_FALSE(filterProcessor.process(block.data(), block.data(), 4, false));
+
+    auto silentBlocks = 0;
+    block.fill(0.0);
+    while (!filterProcessor.process(block.data(), block.data(), 4, true)) {
+      block.fill(0.0);
+      ++silentBlocks;
+    }
+    CHECK(silentBlocks == (biquadTail + 3) / 4);
+    CHECK(isSilent(block.data(), 4));
+
+    block = {{1.0, 0.0, 0.0, 0.0}};
+    CHECK_FALSE(filterProcessor.process(block.data(), block.data(), 4, false));
+    CHECK(block[0] != 0.0);
+  }
+
+  SECTION("Scratch planning")
+  {
+    const auto gain = module<Gain>(Value<gain::Gain>{0.5});
+    const auto chain = serial(parallel(gain, parallel(gain, module<Delay>())),
+                              parallel(serial(parallel(gain, gain), gain), gain),
+                              serial(gain, gain));
+
+    auto reference = chain.makeProcessor<double>(48e3);
+    auto processor = chain.makeProcessor<double>(48e3);
+
+    // Nested parallel groups need their own buffers, siblings share theirs
+    CHECK(decltype(processor)::numScratchBuffers == 4);
+
+    processor.prepare(48e3, 16);
+
+    std::array<double, 16> in{};
+    std::array<double, 16> out{};
+    for (auto n = 0; n < 3; ++n) {
+      for (auto i = 0; i < 16; ++i) {
+        in[i] = double(i + n * 16);
+      }
+
+      processor.process(in.data(), out.data(), 16);
+
+      for (auto i = 0; i < 16; ++i) {
+        CHECK(out[i] == reference.tick(in[i]));
+      }
+    }
+  }
+
+  SECTION("Block kernels")
+  {
+    // Block kernels can differ from tick by rounding errors, which near a wrap can
+    // leave the output on either side of it
+    const auto wrappedDifference = [](double a, double b, double wrap) {
+      const auto difference = std::fmod(std::abs(a - b), wrap);
+      return std::min(difference, wrap - difference);
+    };
+
+    const auto accumulator =
+      serial(module<Accumulator, Expose<accumulator::Amount, accumulator::Wrap>>());
+
+    auto reference = accumulator.makeProcessor<double>(48e3);
+    auto processor = accumulator.makeProcessor<double>(48e3);
+    processor.prepare(48e3, 64);
+
+    std::array<double, 64> in{};
+    std::array<double, 64> out{};
+
+    auto checkAccumulator = [&](int numFrames, double tolerance) {
+      processor.process(in.data(), out.data(), numFrames);
+      for (auto i = 0; i < numFrames; ++i) {
+        CHECK(wrappedDifference(out[i], reference.tick(in[i]), 2.0) <= tolerance);
+      }
+    };
+
+    const auto setAccumulatorValues = [&](double amount, double wrap) {
+      for (auto* p : {&processor, &reference}) {
+        hana::at_c<0>(p->exposedInputs())->setValue(amount);
+        hana::at_c<1>(p->exposedInputs())->setValue(wrap);
+      }
+    };
+
+    setAccumulatorValues(0.5, 2.0);
+    in.fill(0.5);
+    checkAccumulator(64, 0.0);
+    checkAccumulator(13, 0.0);
+
+    for (auto i = 0; i < 64; ++i) {
+      in[i] = double((i * 7919) % 101) / 37.0;
+    }
+    checkAccumulator(64, 1e-12);
+
+    setAccumulatorValues(0.75, 2.0);
+    checkAccumulator(61, 1e-12);
+
+    // Negative increments are processed sample by sample
+    in[5] = -1.0;
+    checkAccumulator(64, 1e-12);
+
+    const auto checkPhasor = [&](auto sample, double tolerance) {
+      using Sample = decltype(sample);
+      const auto chain = serial(module<Phasor, Expose<phasor::Frequency>>());
+
+      auto reference = chain.makeProcessor<Sample>(48e3);
+      auto processor = chain.makeProcessor<Sample>(48e3);
+      processor.prepare(48e3, 256);
+
+      std::array<Sample, 256> block{};
+
+      for (const auto frequency : {440.0, 12345.6, -3000.0, 24e3, 0.0, 1.0}) {
+        hana::at_c<0>(reference.exposedInputs())->setValue(frequency);
+        hana::at_c<0>(processor.exposedInputs())->setValue(frequency);
+
+        for (const auto numFrames : {256, 1, 100}) {
+          processor.process(block.data(), block.data(), numFrames);
+          for (auto i = 0; i < numFrames; ++i) {
+            CHECK(wrappedDifference(block[i], reference.tick(), 1.0) <= tolerance);
+          }
+        }
+      }
+    };
+
+    checkPhasor(double(0), 1e-12);
+    checkPhasor(float(0), 1e-4);
+
+    // Parameters are latched once per block, so changes within a block are made by
+    // splitting it into sub-blocks, here with a modulation matrix, and each sub-block
+    // matches ticking with the value that it was given
+    const auto checkModulated = [&](auto chain, double base, double depth,
+                                    double wrap) {
+      const auto subBlockSize = 16;
+      const auto source = serial(module<Accumulator>(Value<accumulator::Amount>{0.1},
+                                                     Value<accumulator::Wrap>{1.0}));
+
+      auto reference = chain.template makeProcessor<double>(48e3);
+      auto referenceSource = source.template makeProcessor<double>(48e3);
+      auto processor = chain.template makeProcessor<double>(48e3);
+      processor.prepare(48e3, 64);
+      auto matrix = modulationMatrix<double>(subBlockSize,
+                                             source.template makeProcessor<double>(48e3));
+      auto target = hana::at_c<0>(processor.exposedInputs());
+      target->setValue(base);
+      matrix.addRoute(0, target, depth);
+      matrix.prepare(48e3, 64);
+
+      std::array<double, 64> block{};
+      for (auto i = 0; i < 64; ++i) {
+        block[i] = double((i * 7919) % 101) / 101.0;
+      }
+      std::array<double, 64> out{};
+      for (auto numFrames : {64, 64, 40}) {
+        matrix.process(processor, block.data(), out.data(), numFrames);
+        for (auto i = 0; i < numFrames; ++i) {
+          const auto control = referenceSource.tick(block[i]);
+          if (i % subBlockSize == 0) {
+            hana::at_c<0>(reference.exposedInputs())->setValue(base + depth * control);
+          }
+          CHECK(wrappedDifference(out[i], reference.tick(block[i]), wrap) <= 1e-12);
+        }
+      }
+    };
+
+    checkModulated(serial(module<Accumulator, Expose<accumulator::Amount>>(
+                     Value<accumulator::Wrap>{2.0})),
+                   0.5, 0.4, 2.0);
+    checkModulated(
+      serial(module<Phasor, Expose<phasor::Frequency>>()), 440.0, 2000.0, 1.0);
+  }
+
+  SECTION("Crossfade curves")
+  {
+    const auto crossfade = [](double curve, double fade) {
+      return module<Crossfade, Expose<crossfade::Fade>>(Value<crossfade::Curve>{curve},
+                                                        Value<crossfade::Fade>{fade})
+        .makeProcessor<double>(48e3);
+    };
+
+    const auto a = std::array<double, 2>{{1.0, 0.0}};
+    const auto b = std::array<double, 2>{{0.0, 1.0}};
+
+    for (const auto fade : {0.0, 0.1, 0.25, 0.5, 0.9, 1.0}) {
+      auto linear = crossfade(0, fade);
+      CHECK(linear.tick(a) == 1.0 - fade);
+      CHECK(linear.tick(b) == fade);
+
+      auto equalPower = crossfade(1, fade);
+      CHECK(equalPower.tick(a) == Approx(std::cos(fade * M_PI / 2)).margin(1e-5));
+      CHECK(equalPower.tick(b) == Approx(std::sin(fade * M_PI / 2)).margin(1e-5));
+
+      auto sCurve = crossfade(2, fade);
+      CHECK(sCurve.tick(b) == Approx(fade * fade * (3 - 2 * fade)));
+
+      auto logarithmic = crossfade(3, fade);
+      CHECK(logarithmic.tick(a) == Approx(std::log10(1 + 9 * (1 - fade))).margin(1e-4));
+      CHECK(logarithmic.tick(b) == Approx(std::log10(1 + 9 * fade)).margin(1e-4));
+    }
+
+    // In block mode the fade is smoothed from its previous value over the block
+    for (const auto curve : {0.0, 1.0, 2.0, 3.0}) {
+      auto processor = crossfade(curve, 0.0);
+      auto reference = crossfade(curve, 0.0);
+      auto fade = hana::at_c<0>(processor.exposedInputs());
+      auto referenceFade = hana::at_c<0>(reference.exposedInputs());
+
+      std::array<double, 8> left{};
+      std::array<double, 8> right{};
+      std::array<double, 8> out{};
+      for (auto i = 0; i < 8; ++i) {
+        left[i] = 1.0 + i;
+        right[i] = -2.0 * i;
+      }
+
+      fade->setValue(1.0);
+      processor.process(std::array<const double*, 2>{{left.data(), right.data()}},
+                        out.data(), 8);
+
+      for (auto i = 0; i < 8; ++i) {
+        referenceFade->setValue((i + 1) / 8.0);
+        CHECK(out[i] == Approx(reference.tick(std::array<double, 2>{{left[i], right[i]}})));
+      }
+
+      processor.process(std::array<const double*, 2>{{left.data(), right.data()}},
+                        out.data(), 8);
+      for (auto i = 0; i < 8; ++i) {
+        CHECK(out[i] == Approx(reference.tick(std::array<double, 2>{{left[i], right[i]}})));
+      }
+    }
+
+    // Out of range curves are clamped to the nearest curve, and logarithmic fades are
+    // clamped to the ends of the table
+    for (const auto fade : {-0.5, 1.5}) {
+      auto logarithmic = crossfade(7, fade);
+      auto linear = crossfade(-2, fade);
+      const auto expected = fade < 0.0 ? 1.0 : 0.0;
+      CHECK(logarithmic.tick(a) == Approx(expected).margin(1e-12));
+      CHECK(logarithmic.tick(b) == Approx(1.0 - expected).margin(1e-12));
+      CHECK(linear.tick(b) == fade);
+
+      std::array<double, 8> out{};
+      out.fill(-1.0);
+      const auto ones = std::array<double, 8>{{1, 1, 1, 1, 1, 1, 1, 1}};
+      logarithmic.process(std::array<const double*, 2>{{ones.data(), ones.data()}},
+                          out.data(), 8);
+      for (const auto sample : out) {
+        CHECK(sample == Approx(1.0));
+      }
+    }
+
+    // Fixed-point crossfades clamp in the same way
+    using dsp::Q31;
+    auto fixed = module<Crossfade>(Value<crossfade::Curve>{9}, Value<crossfade::Fade>{2.0})
+                   .makeProcessor<Q31>(48e3);
+    const auto half = Q31(0.5);
+    CHECK(double(fixed.tick(std::array<Q31, 2>{{half, Q31(0)}})) == Approx(0.0));
+    CHECK(double(fixed.tick(std::array<Q31, 2>{{Q31(0), half}})) == Approx(0.5));
+  }
+
+  SECTION("Fast math")
+  {
+    namespace fastmath = dsp::fastmath;
+
+    const auto checkAccuracy = [](auto accuracy, auto sample, double tolerance) {
+      using Accuracy = decltype(accuracy);
+      using Sample = decltype(sample);
+
+      const auto relativeError = [](double value, double expected) {
+        return std::abs(value - expected) / std::max(std::abs(expected), 1.0);
+      };
+
+      auto maxError = 0.0;
+      for (auto i = 0; i <= 1000; ++i) {
+        const auto x = Sample(-2.0 * M_PI + i * 4.0 * M_PI / 1000);
+        maxError = std::max(maxError, std::abs(Accuracy::sin(x) - std::sin(double(x))));
+        maxError = std::max(maxError, std::abs(Accuracy::cos(x) - std::cos(double(x))));
+
+        const auto t = Sample(-1.5 + i * 3.0 / 1000);
+        maxError = std::max(maxError, relativeError(Accuracy::tan(t), std::tan(double(t))));
+
+        const auto e = Sample(-20.0 + i * 40.0 / 1000);
+        maxError = std::max(maxError, relativeError(Accuracy::exp(e), std::exp(double(e))));
+
+        const auto p = Sample(1e-3 + i * 20.0 / 1000);
+        maxError = std::max(maxError, relativeError(Accuracy::log2(p), std::log2(double(p))));
+        maxError = std::max(
+          maxError, relativeError(Accuracy::pow(p, Sample(1.5)), std::pow(double(p), 1.5)));
+      }
+
+      CHECK(maxError <= tolerance);
+    };
+
+    checkAccuracy(fastmath::Exact{}, double(0), 1e-15);
+    checkAccuracy(fastmath::Precise{}, double(0), 1e-6);
+    checkAccuracy(fastmath::Fast{}, double(0), 1e-3);
+    checkAccuracy(fastmath::Precise{}, float(0), 2e-6);
+    checkAccuracy(fastmath::Fast{}, float(0), 1e-3);
+
+    // Results saturate at the ends of the exponent range, and log2 handles zero,
+    // denormals, infinity and negative values
+    const auto checkDomainEdges = [](auto accuracy, auto sample, double tolerance) {
+      using Accuracy = decltype(accuracy);
+      using Sample = decltype(sample);
+      using Limits = std::numeric_limits<Sample>;
+      const auto bias = Sample(Limits::max_exponent - 1);
+
+      for (const auto x : {Sample(-750), -Limits::max(), -Limits::infinity()}) {
+        CHECK(Accuracy::exp(x) == Sample(0));
+      }
+      // Results below the smallest normal value may be flushed to zero
+      const auto tiny = Accuracy::exp(Sample(-100));
+      CHECK(tiny >= Sample(0));
+      CHECK(tiny <= Sample(std::exp(-100.0) * (1.0 + tolerance)) + Limits::min());
+      for (const auto x : {Sample(800), Limits::max(), Limits::infinity()}) {
+        CHECK(std::isinf(Accuracy::exp(x)));
+      }
+      for (const auto x : {bias - Sample(1), Sample(1) - bias, bias - Sample(0.6)}) {
+        const auto expected = std::exp2(double(x));
+        CHECK(std::abs(Accuracy::exp2(x) - expected) / expected <= tolerance);
+      }
+      CHECK(std::isnan(Accuracy::exp2(Limits::quiet_NaN())));
+
+      CHECK(Accuracy::log2(Sample(0)) == -Limits::infinity());
+      CHECK(Accuracy::log2(Limits::infinity()) == Limits::infinity());
+      CHECK(std::isnan(Accuracy::log2(Sample(-1))));
+      const auto denormal = Limits::min() / Sample(3);
+      for (const auto x : {Limits::denorm_min(), denormal, Limits::max()}) {
+        const auto expected = std::log2(double(x));
+        CHECK(std::abs(Accuracy::log2(x) - expected) / std::abs(expected) <= tolerance);
+      }
+      CHECK(Accuracy::pow(Sample(0), Sample(1.5)) == Sample(0));
+      CHECK(fastmath::detail::roundToInt(Sample(1e12)) == 1 << 30);
+      CHECK(fastmath::detail::roundToInt(-Limits::infinity()) == -(1 << 30));
+    };
+
+    checkDomainEdges(fastmath::Precise{}, double(0), 1e-6);
+    checkDomainEdges(fastmath::Fast{}, double(0), 1e-3);
+    checkDomainEdges(fastmath::Precise{}, float(0), 2e-6);
+    checkDomainEdges(fastmath::Fast{}, float(0), 1e-3);
+
+    // The accuracy is selected per chain when making its processor
+    const auto filter = serial(
+      split(module<Biquad>(Value<biquad::Frequency>{5000.0}, Value<biquad::Q>{2.0}),
+            module<Wire>()),
+      module<Crossfade>(Value<crossfade::Curve>{1}, Value<crossfade::Fade>{0.3}));
+
+    auto exact = filter.makeProcessor<double, fastmath::Exact>(48e3);
+    auto byDefault = filter.makeProcessor<double>(48e3);
+    auto precise = filter.makeProcessor<double, fastmath::Precise>(48e3);
+    auto fast = filter.makeProcessor<double, fastmath::Fast>(48e3);
+    for (auto i = 0; i < 100; ++i) {
+      const auto in = i == 0 ? 1.0 : 0.0;
+      const auto expected = exact.tick(in);
+      CHECK(byDefault.tick(in) == expected);
+      CHECK(precise.tick(in) == Approx(expected).margin(1e-5));
+      CHECK(fast.tick(in) == Approx(expected).margin(1e-2));
+    }
+  }
+
+  SECTION("FFT")
+  {
+    const auto size = 64;
+    const auto fft = dsp::sharedFft<double>(size);
+    CHECK(fft == dsp::sharedFft<double>(size));
+
+    std::vector<double> in(size);
+    for (auto i = 0; i < size; ++i) {
+      in[i] = std::sin(i * 0.3) + 0.25 * (i % 7);
+    }
+
+    std::vector<double> re(fft->numBins());
+    std::vector<double> im(fft->numBins());
+    fft->forward(in.data(), re.data(), im.data());
+
+    for (auto k = 0; k < fft->numBins(); ++k) {
+      auto expectedRe = 0.0;
+      auto expectedIm = 0.0;
+      for (auto n = 0; n < size; ++n) {
+        expectedRe += in[n] * std::cos(2.0 * M_PI * k * n / size);
+        expectedIm -= in[n] * std::sin(2.0 * M_PI * k * n / size);
+      }
+      CHECK(re[k] == Approx(expectedRe).margin(1e-9));
+      CHECK(im[k] == Approx(expectedIm).margin(1e-9));
+    }
+
+    std::vector<double> out(size);
+    fft->inverse(re.data(), im.data(), out.data());
+    for (auto i = 0; i < size; ++i) {
+      CHECK(out[i] == Approx(in[i]).margin(1e-12));
+    }
+  }
+
+  SECTION("Convolver")
+  {
+    const auto checkConvolver = [](auto chain, const std::vector<double>& ir, int latency) {
+      auto processor = chain.template makeProcessor<double>(48e3);
+      processor.prepare(48e3, 128);
+      CHECK(processor.latency() == latency);
+
+      const auto numFrames = 3000;
+      std::vector<double> in(numFrames);
+      for (auto i = 0; i < numFrames; ++i) {
+        in[i] = std::sin(i * 0.05) + (i % 13 == 0 ? 1.0 : 0.0);
+      }
+
+      std::vector<double> out(numFrames);
+      for (auto offset = 0, blockSize = 1; offset < numFrames;
+           offset += blockSize, blockSize = blockSize % 97 + 7) {
+        blockSize = std::min(blockSize, numFrames - offset);
+        processor.process(&in[offset], &out[offset], blockSize);
+      }
+
+      for (auto n = 0; n < numFrames; ++n) {
+        auto expected = 0.0;
+        for (auto k = 0; k < int(ir.size()) && k <= n - latency; ++k) {
+          expected += ir[k] * in[n - latency - k];
+        }
+        CHECK(out[n] == Approx(expected).margin(1e-9));
+      }
+    };
+
+    checkConvolver(serial(module<Convolver<TestRoom>>()), TestRoom::samples(), 0);
+    checkConvolver(serial(module<Convolver<TestCabinet>>(), module<Gain>()),
+                   TestCabinet::samples(), 16);
+
+    // Impulse responses loaded at runtime are shared by the processors made from the
+    // module, and long heads are partitioned again rather than convolved directly
+    const auto samples = testImpulseResponse(700);
+    const auto ir =
+      std::make_shared<const dsp::PartitionedImpulseResponse<double>>(samples, 128, true);
+    CHECK(ir->head.empty());
+    REQUIRE(ir->headResponse);
+    CHECK(ir->headResponse->partitionSize == 32);
+    checkConvolver(serial(convolver::withImpulseResponse(ir, "Room")), samples, 0);
+
+    // Ticking matches processing in blocks
+    auto ticked = convolver::withImpulseResponse(ir).makeProcessor<double>(48e3);
+    auto blocks = convolver::withImpulseResponse(ir).makeProcessor<double>(48e3);
+    std::vector<double> block(200);
+    for (auto i = 0; i < int(block.size()); ++i) {
+      block[i] = std::cos(i * 0.3);
+    }
+    std::vector<double> blockOut(block.size());
+    blocks.process(block.data(), blockOut.data(), int(block.size()));
+    for (auto i = 0; i < int(block.size()); ++i) {
+      CHECK(ticked.tick(block[i]) == Approx(blockOut[i]).margin(1e-12));
+    }
+  }
+
+  SECTION("Spectral")
+  {
+    const auto checkSpectral = [](auto chain, double gain, int latency) {
+      auto processor = chain.template makeProcessor<double>(48e3);
+      processor.prepare(48e3, 64);
+      CHECK(processor.latency() == latency);
+
+      const auto numFrames = 1000;
+      std::vector<double> in(numFrames);
+      for (auto i = 0; i < numFrames; ++i) {
+        in[i] = std::sin(i * 0.05) + (i % 13 == 0 ? 1.0 : 0.0);
+      }
+
+      std::vector<double> out(numFrames);
+      for (auto offset = 0; offset < numFrames; offset += 50) {
+        processor.process(&in[offset], &out[offset], 50);
+      }
+
+      for (auto n = 0; n < numFrames; ++n) {
+        const auto expected = n < latency ? 0.0 : in[n - latency] * gain;
+        CHECK(out[n] == Approx(expected).margin(1e-9));
+      }
+    };
+
+    checkSpectral(spectral(64, 16, module<Gain>()), 1.0, 63);
+    checkSpectral(spectral(32, 16, module<Gain>(Value<gain::Gain>{0.5})), 0.5, 31);
+    checkSpectral(serial(spectral(64, 32, parallel(module<Gain>(), module<Gain>())),
+                         module<Gain>(Value<gain::Gain>{0.25})),
+                  0.5, 63);
+
+    // A spectral gate silences quiet tones, and passes loud ones through apart from
+    // their leakage into bins below the threshold
+    const auto tone = [](double amplitude, int bin) {
+      std::vector<double> samples(2000);
+      for (auto i = 0; i < int(samples.size()); ++i) {
+        samples[i] = amplitude * std::sin(2.0 * M_PI * bin * i / 64.0);
+      }
+      return samples;
+    };
+    const auto gated = [](std::vector<double> samples) {
+      auto gate =
+        spectral(64, 16, module<spectral_gate::Module>()).makeProcessor<double>(48e3);
+      gate.prepare(48e3, 100);
+      for (auto offset = 0; offset < int(samples.size()); offset += 100) {
+        gate.process(&samples[offset], &samples[offset], 100);
+      }
+      return samples;
+    };
+
+    const auto loud = tone(1.0, 4);
+    const auto quiet = tone(0.01, 16);
+    auto mixed = loud;
+    std::transform(loud.begin(), loud.end(), quiet.begin(), mixed.begin(),
+                   std::plus<double>());
+    const auto gatedLoud = gated(loud);
+    const auto gatedQuiet = gated(quiet);
+    const auto gatedMixed = gated(mixed);
+    for (auto n = 200; n < int(mixed.size()); ++n) {
+      CHECK(gatedQuiet[n] == 0.0);
+      CHECK(gatedMixed[n] == Approx(gatedLoud[n]).margin(1e-6));
+      CHECK(gatedLoud[n] == Approx(loud[n - 63]).margin(0.01));
+    }
+
+    // The inner chain's exposed inputs are exposed by the spectral processor
+    const auto muted = spectral(64, 16, module<Gain, Expose<gain::Gain>>());
+    auto processor = muted.makeProcessor<double>(48e3);
+    hana::at_c<0>(processor.exposedInputs())->setValue(0.0);
+    for (auto i = 0; i < 200; ++i) {
+      CHECK(processor.tick(std::sin(i * 0.3) + 1.0) == Approx(0.0).margin(1e-12));
+    }
+  }
+
+  SECTION("Render")
+  {
+    const auto numFrames = 3000;
+    std::vector<float> left(numFrames);
+    std::vector<float> right(numFrames);
+    for (auto i = 0; i < numFrames; ++i) {
+      left[i] = float(std::sin(i * 0.01));
+      right[i] = float(i % 100) / 100.0f;
+    }
+
+    const std::string inputPath = "chains-render-input.wav";
+    const std::string outputPath = "chains-render-output.wav";
+
+    // A small write-behind buffer makes the writer hand over several buffers
+    io::WavFileWriter writer;
+    REQUIRE(writer.open(inputPath, 2, 48e3, 256));
+    const float* channels[] = {left.data(), right.data()};
+    writer.write(channels, numFrames);
+    REQUIRE(writer.close());
+
+    io::AudioFileReader input;
+    REQUIRE(input.openWav(inputPath));
+    CHECK(input.numFrames() == numFrames);
+    CHECK(input.format().numChannels == 2);
+    CHECK(input.format().sampleRate == 48e3);
+
+    const auto chain = serial(module<Gain>(Value<gain::Gain>(0.5)));
+    const auto processor = chain.makeProcessor<double>(48e3);
+    io::WavFileWriter output;
+    REQUIRE(output.open(outputPath, 2, 48e3, 300));
+    const auto stats = render<double>(processor, input, output, 128);
+    REQUIRE(output.close());
+    CHECK(stats.numFrames == numFrames);
+    CHECK(stats.numChannels == 2);
+
+    io::AudioFileReader rendered;
+    REQUIRE(rendered.openWav(outputPath));
+    REQUIRE(rendered.numFrames() == numFrames);
+    std::vector<double> result(numFrames);
+    rendered.read(0, 0, numFrames, result.data());
+    for (auto i = 0; i < numFrames; ++i) {
+      CHECK(result[i] == Approx(left[i] * 0.5).margin(1e-6));
+    }
+    rendered.read(1, 1000, 10, result.data());
+    for (auto i = 0; i < 10; ++i) {
+      CHECK(result[i] == Approx(right[1000 + i] * 0.5).margin(1e-6));
+    }
+
+    // All channels can be read at once, a block per channel
+    std::vector<double> leftBlock(20);
+    std::vector<double> rightBlock(20);
+    double* blocks[] = {leftBlock.data(), rightBlock.data()};
+    rendered.read(500, 20, blocks);
+    for (auto i = 0; i < 20; ++i) {
+      CHECK(leftBlock[i] == Approx(left[500 + i] * 0.5).margin(1e-6));
+      CHECK(rightBlock[i] == Approx(right[500 + i] * 0.5).margin(1e-6));
+    }
+
+    // Raw input is read in the given format
+    io::AudioFileReader raw;
+    REQUIRE(raw.openRaw(inputPath, {io::SampleFormat::Int16, 1, 48e3}));
+    CHECK(raw.numFrames() == (44 + numFrames * 2 * 4) / 2);
+    CHECK_FALSE(raw.openWav(inputPath + ".missing"));
+
+    // Raw formats without channels or with an unknown sample format are rejected
+    CHECK_FALSE(raw.openRaw(inputPath, {io::SampleFormat::Int16, 0, 48e3}));
+    CHECK(raw.numFrames() == 0);
+    CHECK_FALSE(raw.error().empty());
+    CHECK_FALSE(raw.openRaw(inputPath, {io::SampleFormat(42), 1, 48e3}));
+    CHECK(raw.numFrames() == 0);
+
+    std::remove(inputPath.c_str());
+    std::remove(outputPath.c_str());
+  }
+
+  SECTION("Multi-stream engine")
+  {
+    using namespace accumulator;
+
+    const auto chain = serial(module<Accumulator, Expose<Amount>>());
+    auto prototype = chain.makeProcessor<double>(48e3);
+    hana::at_c<0>(prototype.exposedInputs())->setValue(0.25);
+
+    using Engine = MultiStreamEngine<double, decltype(prototype)>;
+    Engine::Options options;
+    options.numWorkers = 3;
+    options.blockSize = 16;
+    options.pinWorkers = false;
+    // A deadline that can't be missed
+    options.sampleRate = 1e-3;
+
+    const auto numStreams = 37;
+    Engine engine(prototype, numStreams, options);
+    CHECK(engine.numStreams() == numStreams);
+    CHECK(engine.numWorkers() == 3);
+
+    auto reference = makeClones(prototype, numStreams);
+    for (auto& processor : reference) {
+      processor.prepare(48e3, 16);
+    }
+    std::vector<double> expected(16);
+
+    for (auto block = 0; block < 20; ++block) {
+      for (auto stream = 0; stream < numStreams; ++stream) {
+        std::fill_n(engine.input(stream), 16, double(stream % 5));
+      }
+
+      engine.process();
+
+      for (auto stream = 0; stream < numStreams; ++stream) {
+        std::vector<double> in(16, double(stream % 5));
+        reference[stream].process(in.data(), expected.data(), 16);
+        for (auto i = 0; i < 16; ++i) {
+          CHECK(engine.output(stream)[i] == Approx(expected[i]));
+        }
+      }
+    }
+
+    CHECK(engine.totalDeadlineMisses() == 0);
+  }
+
+  SECTION("Pipeline")
+  {
+    using namespace accumulator;
+
+    const auto chain = serial(module<Accumulator>(Value<Amount>(0.1)),
+                              module<Gain>(Value<gain::Gain>(0.5)),
+                              module<Biquad>(Value<biquad::Frequency>(1000.0)),
+                              parallel(module<Wire>(), module<Delay>(Value<delay::Length>(3))),
+                              module<Accumulator>(Value<Amount>(0.01)));
+    auto reference = chain.makeProcessor<double>(48e3);
+    reference.prepare(48e3, 20 * 32);
+
+    auto pipeline = pipelined(chain.makeProcessor<double>(48e3), 3, false);
+    pipeline.prepare(48e3, 32);
+    CHECK(pipeline.numStages() == 3);
+    CHECK(pipeline.latency() == 2 * 32);
+    CHECK(pipeline.stageStart(0) == 0);
+    CHECK(pipeline.stageStart(1) < pipeline.stageStart(2));
+    CHECK(pipeline.stageStart(3) == 5);
+
+    for (auto pass = 0; pass < 2; ++pass) {
+      const auto numBlocks = 20;
+      std::vector<double> in(numBlocks * 32);
+      for (auto i = 0; i < int(in.size()); ++i) {
+        in[i] = std::sin(i * 0.1);
+      }
+      std::vector<double> expected(in.size());
+      std::vector<double> out(in.size());
+      reference.process(in.data(), expected.data(), int(in.size()));
+      for (auto block = 0; block < numBlocks; ++block) {
+        pipeline.process(&in[block * 32], &out[block * 32], 32);
+      }
+
+      for (auto i = 0; i < int(out.size()); ++i) {
+        CHECK(out[i] == Approx(i < 64 ? 0.0 : expected[i - 64]).margin(1e-12));
+      }
+
+      // Resetting clears the processors and the blocks in flight
+      reference.reset();
+      pipeline.reset();
+    }
+
+    // Resetting mid-stream drops the blocks in flight, and the pipeline starts again
+    // from silence
+    {
+      std::vector<double> in(32, 0.25);
+      std::vector<double> out(32);
+      for (auto block = 0; block < 3; ++block) {
+        pipeline.process(in.data(), out.data(), 32);
+      }
+      pipeline.reset();
+      reference.reset();
+
+      std::vector<double> expected(32);
+      reference.process(in.data(), expected.data(), 32);
+      for (auto block = 0; block < 3; ++block) {
+        pipeline.process(in.data(), out.data(), 32);
+        if (block < 2) {
+          CHECK(std::all_of(out.begin(), out.end(), [](double x) { return x == 0.0; }));
+        }
+      }
+      for (auto i = 0; i < 32; ++i) {
+        CHECK(out[i] == Approx(expected[i]).margin(1e-12));
+      }
+    }
+
+    // Snapshots include the blocks in flight, so a restored pipeline continues where the
+    // snapshot was taken
+    {
+      std::vector<double> in(32);
+      std::vector<double> out(32);
+      const auto fill = [&in](int block) {
+        for (auto i = 0; i < 32; ++i) {
+          in[i] = std::sin((block * 32 + i) * 0.1);
+        }
+      };
+      for (auto block = 0; block < 5; ++block) {
+        fill(block);
+        pipeline.process(in.data(), out.data(), 32);
+      }
+      const auto state = snapshot(pipeline);
+
+      auto restored = pipelined(chain.makeProcessor<double>(48e3), 3, false);
+      restored.prepare(48e3, 32);
+      REQUIRE(restoreSnapshot(restored, state));
+      std::vector<double> restoredOut(32);
+      for (auto block = 5; block < 10; ++block) {
+        fill(block);
+        pipeline.process(in.data(), out.data(), 32);
+        restored.process(in.data(), restoredOut.data(), 32);
+        CHECK(restoredOut == out);
+      }
+      pipeline.reset();
+      reference.reset();
+    }
+
+    // Resetting before preparing does nothing
+    auto unprepared = pipelined(chain.makeProcessor<double>(48e3), 3, false);
+    unprepared.reset();
+    unprepared.prepare(48e3, 32);
+    unprepared.reset();
+    CHECK(unprepared.numStages() == 3);
+
+    // A single stage runs on the calling thread without latency
+    auto single = pipelined(chain.makeProcessor<double>(48e3), 1);
+    single.prepare(48e3, 16);
+    CHECK(single.latency() == 0);
+  }
+
+  SECTION("Real-time engine")
+  {
+    const auto chain = serial(module<Gain>(Value<gain::Gain>(0.5)));
+    auto processor = chain.makeProcessor<double>(48e3);
+
+    using Engine = RealtimeEngine<double, decltype(processor)>;
+    Engine::Options options;
+    options.blockSize = 64;
+    options.wavPath = "chains-realtime-output.wav";
+    Engine engine(processor, options);
+
+    REQUIRE(engine.runFor(20));
+    const auto& stats = engine.stats();
+    CHECK(stats.numCallbacks == 20);
+    CHECK(std::accumulate(stats.histogram.begin(), stats.histogram.end(), 0) == 20);
+    CHECK(stats.maxCallbackTime >= stats.meanCallbackTime());
+    CHECK(stats.numXruns <= stats.numCallbacks);
+    CHECK(stats.numDroppedBlocks == 0);
+
+    io::AudioFileReader output;
+    REQUIRE(output.openWav(options.wavPath));
+    CHECK(output.numFrames() == 20 * 64);
+    std::vector<double> block(64);
+    output.read(0, 0, 64, block.data());
+    std::vector<double> laterBlock(64);
+    output.read(0, 19 * 64, 64, laterBlock.data());
+    CHECK(block == laterBlock);
+    CHECK(std::any_of(block.begin(), block.end(), [](double x) { return x != 0.0; }));
+    std::remove(options.wavPath.c_str());
+  }
+
+  SECTION("Modulation")
+  {
+    using namespace accumulator;
+
+    const auto chain = serial(module<Gain, Expose<gain::Gain>>());
+    auto processor = chain.makeProcessor<double>(48e3);
+    processor.prepare(48e3, 64);
+    auto gain = hana::at_c<0>(processor.exposedInputs());
+    gain->setValue(0.5);
+
+    auto matrix = modulationMatrix<double>(
+      16,
+      serial(module<Accumulator>(Value<Amount>(0.01), Value<Wrap>(100.0)))
+        .makeProcessor<double>(48e3),
+      serial(module<Ones>()).makeProcessor<double>(48e3));
+    matrix.addRoute(0, gain, 2.0);
+    const auto onesRoute = matrix.addRoute(1, gain, 0.25, modulation::Curve::Unipolar);
+    matrix.prepare(48e3, 64);
+
+    const std::vector<double> in(64, 1.0);
+    std::vector<double> out(64);
+    for (auto block = 0; block < 3; ++block) {
+      matrix.process(processor, in.data(), out.data(), 64);
+      for (auto i = 0; i < 64; ++i) {
+        const auto subBlockStart = block * 64 + i / 16 * 16;
+        CHECK(out[i] == Approx(0.5 + 2.0 * 0.01 * (subBlockStart + 1) + 0.25));
+      }
+    }
+
+    // Routes to the same target are summed, and the base value can be changed
+    matrix.setDepth(onesRoute, -1.0);
+    matrix.setBaseValue(gain, 1.0);
+    matrix.process(processor, in.data(), out.data(), 10);
+    CHECK(out[0] == Approx(1.0 + 2.0 * 0.01 * (3 * 64 + 1) - 1.0));
+
+    // Inputs with callbacks can be modulated too
+    const auto phasor = serial(module<Phasor, Expose<phasor::Frequency>>());
+    auto phasorProcessor = phasor.makeProcessor<double>(48e3);
+    phasorProcessor.prepare(48e3, 64);
+    auto phasorMatrix =
+      modulationMatrix<double>(32, serial(module<Ones>()).makeProcessor<double>(48e3));
+    auto frequency = hana::at_c<0>(phasorProcessor.exposedInputs());
+    frequency->setValue(0.0);
+    phasorMatrix.addRoute(0, frequency, 480.0);
+    phasorMatrix.prepare(48e3, 64);
+    phasorMatrix.process(phasorProcessor, in.data(), out.data(), 64);
+    CHECK(frequency->value() == 480.0);
+    CHECK(out[11] - out[10] == Approx(0.01));
+
+    // Targets can be added after the matrix has been prepared
+    auto gains = serial(module<Gain, Expose<gain::Gain>>("A"),
+                        module<Gain, Expose<gain::Gain>>("B"))
+                   .makeProcessor<double>(48e3);
+    gains.prepare(48e3, 64);
+    auto gainA = hana::at_c<0>(gains.exposedInputs());
+    auto gainB = hana::at_c<1>(gains.exposedInputs());
+    auto gainMatrix =
+      modulationMatrix<double>(16, serial(module<Ones>()).makeProcessor<double>(48e3));
+    gainMatrix.addRoute(0, gainA, 1.0);
+    gainMatrix.prepare(48e3, 64);
+    gainMatrix.process(gains, in.data(), out.data(), 64);
+    CHECK(out[63] == Approx(2.0));
+    gainMatrix.addRoute(0, gainB, 2.0);
+    gainMatrix.setBaseValue(gainB, 0.5);
+    gainMatrix.process(gains, in.data(), out.data(), 64);
+    CHECK(gainB->value() == Approx(2.5));
+    CHECK(out[63] == Approx(2.0 * 2.5));
+  }
+
+  SECTION("Bus")
+  {
+    using namespace accumulator;
+
+    const auto numFrames = 40;
+    std::vector<double> interleaved(numFrames * 2);
+    for (auto i = 0; i < numFrames * 2; ++i) {
+      interleaved[i] = i * 0.01;
+    }
+    std::vector<double> left(numFrames);
+    std::vector<double> right(numFrames);
+    for (auto i = 0; i < numFrames; ++i) {
+      left[i] = interleaved[i * 2];
+      right[i] = interleaved[i * 2 + 1];
+    }
+
+    const auto interleavedBus = Bus<double, 2>::interleaved(interleaved.data(), numFrames);
+    const auto planarBus = Bus<double, 2>::planar({{left.data(), right.data()}}, numFrames);
+    CHECK_FALSE(interleavedBus.isPlanar());
+    CHECK(planarBus.isPlanar());
+    CHECK(interleavedBus(1, 3) == planarBus(1, 3));
+    CHECK(interleavedBus[0][5] == left[5]);
+    CHECK(interleavedBus.subBlock(10, 5)(1, 2) == right[12]);
+    const Bus<const double, 2> constBus = planarBus;
+    CHECK(constBus.numFrames() == numFrames);
+
+    // A mono chain runs on each channel in place, in both layouts
+    const auto chain = serial(module<Accumulator>(Value<Amount>(0.5), Value<Wrap>(100.0)));
+    auto prototype = chain.makeProcessor<double>(48e3);
+    prototype.prepare(48e3, numFrames);
+    std::vector<double> expectedLeft(numFrames);
+    std::vector<double> expectedRight(numFrames);
+    {
+      auto reference = makeClones(prototype, 2);
+      reference[0].process(left.data(), expectedLeft.data(), numFrames);
+      reference[1].process(right.data(), expectedRight.data(), numFrames);
+    }
+
+    auto planarStereo = multiChannel<2>(prototype);
+    planarStereo.process(planarBus);
+    auto interleavedStereo = multiChannel<2>(prototype);
+    interleavedStereo.process(interleavedBus);
+    for (auto i = 0; i < numFrames; ++i) {
+      CHECK(left[i] == Approx(expectedLeft[i]));
+      CHECK(right[i] == Approx(expectedRight[i]));
+      CHECK(interleavedBus(0, i) == Approx(expectedLeft[i]));
+      CHECK(interleavedBus(1, i) == Approx(expectedRight[i]));
+    }
+
+    // Interleaved buses longer than a chunk are processed in blocks, matching ticks
+    {
+      const auto length = 300;
+      std::vector<double> frames(length * 2);
+      for (auto i = 0; i < length * 2; ++i) {
+        frames[i] = std::sin(i * 0.05);
+      }
+      auto reference = makeClones(prototype, 2);
+      std::vector<double> ticked(frames.size());
+      for (auto i = 0; i < length * 2; ++i) {
+        ticked[i] = reference[i % 2].tick(frames[i]);
+      }
+
+      auto stereo = multiChannel<2>(prototype);
+      stereo.prepare(48e3, length);
+      stereo.process(Bus<double, 2>::interleaved(frames.data(), length));
+      for (auto i = 0; i < length * 2; ++i) {
+        CHECK(frames[i] == Approx(ticked[i]).margin(1e-12));
+      }
+    }
+
+    // Crossfades mix a bus's channels in either layout
+    auto crossfade =
+      module<Crossfade>(Value<crossfade::Fade>(0.25)).makeProcessor<double>(48e3);
+    crossfade.init();
+    std::vector<double> planarMix(numFrames);
+    std::vector<double> interleavedMix(numFrames);
+    auto planarFade = crossfade;
+    planarFade.process(planarBus, planarMix.data(), numFrames);
+    auto interleavedFade = crossfade;
+    interleavedFade.process(interleavedBus, interleavedMix.data(), numFrames);
+    for (auto i = 0; i < numFrames; ++i) {
+      CHECK(planarMix[i] == Approx(left[i] * 0.75 + right[i] * 0.25));
+      CHECK(interleavedMix[i] == Approx(planarMix[i]));
+    }
+
+    // Splits write each branch to its own channel
+    const auto fanOut = split(module<Gain>(Value<gain::Gain>(2.0)), module<Wire>());
+    auto fanOutProcessor = fanOut.makeProcessor<double>(48e3);
+    fanOutProcessor.prepare(48e3, numFrames);
+    fanOutProcessor.process(expectedLeft.data(), planarBus, numFrames);
+    fanOutProcessor.process(expectedLeft.data(), interleavedBus, numFrames);
+    for (auto i = 0; i < numFrames; ++i) {
+      CHECK(left[i] == Approx(expectedLeft[i] * 2.0));
+      CHECK(right[i] == Approx(expectedLeft[i]));
+      CHECK(interleavedBus(0, i) == left[i]);
+      CHECK(interleavedBus(1, i) == right[i]);
+    }
+  }
+
+  SECTION("Split")
+  {
+    // The branches keep their state between ticks
+    const auto delays = serial(
+      split(module<Delay>(Value<delay::Length>{1}), module<Delay>(Value<delay::Length>{2})),
+      module<Crossfade>(Value<crossfade::Fade>(0.5)));
+    auto delayed = delays.makeProcessor<double>(48e3);
+    CHECK(delayed.tick(1.0) == 0.0);
+    CHECK(delayed.tick(0.0) == 0.5);
+    CHECK(delayed.tick(0.0) == 0.5);
+    CHECK(delayed.tick(0.0) == 0.0);
+
+    // Blocks are fanned out into scratch channels and mixed down, with nested groups
+    // in the branches using the scratch buffers after the channels
+    const auto chain = serial(
+      module<Gain>(Value<gain::Gain>{0.5}),
+      split(module<Accumulator>(Value<accumulator::Wrap>{4}),
+            serial(module<Delay>(Value<delay::Length>{3}),
+                   parallel(module<Gain>(Value<gain::Gain>{2}), module<Wire>()))),
+      module<Crossfade>(Value<crossfade::Fade>(0.25)),
+      module<Gain>(Value<gain::Gain>{2}));
+    auto reference = chain.makeProcessor<double>(48e3);
+    auto processor = chain.makeProcessor<double>(48e3);
+    CHECK(decltype(processor)::numScratchBuffers == 4);
+    processor.prepare(48e3, 16);
+
+    std::array<double, 16> block{};
+    for (auto n = 0; n < 4; ++n) {
+      for (auto i = 0; i < 16; ++i) {
+        block[i] = 0.125 * (i + n);
+      }
+
+      const auto numFrames = 16 - n;
+      processor.process(block.data(), block.data(), numFrames);
+
+      for (auto i = 0; i < numFrames; ++i) {
+        CHECK(block[i] == Approx(reference.tick(0.125 * (i + n))));
+      }
+    }
+  }
+
+  SECTION("Dynamic chain")
+  {
+    const auto patch = R"(
+      # The same chain as below
+      serial(gain(gain = 0.5),
+             split(biquad(Frequency = 500, Q = 2), delay(length = 3)),
+             crossfade(fade = 0.25),
+             parallel(wire(), recursive(gain(gain = 1), gain(gain = 0.5))))
+    )";
+
+    const auto chain =
+      serial(module<Gain>(Value<gain::Gain>{0.5}),
+             split(module<Biquad>(Value<biquad::Frequency>{500.0}, Value<biquad::Q>{2.0}),
+                   module<Delay>(Value<delay::Length>{3})),
+             module<Crossfade>(Value<crossfade::Fade>(0.25)),
+             parallel(module<Wire>(), recursive(module<Gain>(Value<gain::Gain>{1}),
+                                                module<Gain>(Value<gain::Gain>{0.5}))));
+
+    DynamicChain<double> dynamicChain;
+    REQUIRE(dynamicChain.load(patch, 48e3));
+    dynamicChain.prepare(48e3, 16);
+    CHECK(dynamicChain.latency() == 0);
+
+    auto reference = chain.makeProcessor<double>(48e3);
+    std::array<double, 16> block{};
+    for (auto n = 0; n < 4; ++n) {
+      for (auto i = 0; i < 16; ++i) {
+        block[i] = i + n == 0 ? 1.0 : 0.125 * ((i + n) % 5);
+      }
+
+      const auto numFrames = 16 - n;
+      dynamicChain.process(block.data(), block.data(), numFrames);
+
+      for (auto i = 0; i < numFrames; ++i) {
+        CHECK(block[i] == Approx(reference.tick(i + n == 0 ? 1.0 : 0.125 * ((i + n) % 5))));
+      }
+    }
+
+    // Parameters can be set by name once the chain is running
+    CHECK(dynamicChain.load("gain(gain = 2)", 48e3));
+    dynamicChain.prepare(48e3, 4);
+    CHECK(dynamicChain.root().setParameter("GAIN", 3.0));
+    CHECK_FALSE(dynamicChain.root().setParameter("fade", 1.0));
+    block[0] = 1.0;
+    dynamicChain.process(block.data(), block.data(), 1);
+    CHECK(block[0] == 3.0);
+
+    // Invalid patches are rejected without replacing the loaded chain
+    CHECK_FALSE(dynamicChain.load("serial(gain(), reverb())", 48e3));
+    CHECK(dynamicChain.error() == "line 1: unknown module 'reverb'");
+    CHECK_FALSE(dynamicChain.load("gain(\n  level = 2)", 48e3));
+    CHECK(dynamicChain.error() == "line 2: gain has no parameter 'level'");
+    CHECK_FALSE(dynamicChain.load("serial(gain(), crossfade())", 48e3));
+    CHECK(dynamicChain.error() == "line 1: serial node 2 takes 2 channels, but receives 1");
+    CHECK_FALSE(dynamicChain.load("split(gain(), wire())", 48e3));
+    CHECK(dynamicChain.error() == "the patch needs to be mono");
+    CHECK_FALSE(dynamicChain.load("gain(gain = 2", 48e3));
+    CHECK(dynamicChain.error() == "line 1: expected ')'");
+    CHECK(dynamicChain.isLoaded());
+  }
+
+  SECTION("Swap slot")
+  {
+    const auto makeChain = [](const char* patch) {
+      auto chain = std::make_unique<DynamicChain<double>>();
+      chain->load(patch, 48e3);
+      return chain;
+    };
+
+    SwapSlot<double, DynamicChain<double>>::Options options;
+    options.fadeLength = 8;
+    options.curve = dsp::FadeCurve::Linear;
+    SwapSlot<double, DynamicChain<double>> slot(makeChain("gain(gain = 1)"), options);
+    slot.prepare(48e3, 4);
+
+    std::array<double, 4> block{};
+    const auto processBlock = [&] {
+      block.fill(1.0);
+      slot.process(block.data(), block.data(), 4);
+    };
+
+    processBlock();
+    CHECK(block[3] == 1.0);
+
+    // Processors published before the audio thread picks them up are replaced
+    std::thread background([&] {
+      slot.publish(makeChain("gain(gain = 2)"));
+      slot.publish(makeChain("gain(gain = 3)"));
+    });
+    background.join();
+
+    processBlock();
+    CHECK(slot.isFading());
+    CHECK(block[0] == Approx(1.25));
+    CHECK(block[3] == Approx(2.0));
+    processBlock();
+    CHECK(block[3] == Approx(3.0));
+    CHECK_FALSE(slot.isFading());
+    processBlock();
+    CHECK(block[0] == 3.0);
+
+    // The old processor is handed back to be deleted off the audio thread
+    CHECK(slot.collect() == 1);
+    CHECK(slot.collect() == 0);
+  }
+
+  SECTION("State snapshots")
+  {
+    const auto chain = serial(
+      parallel(module<Phasor>(Value<phasor::Frequency>{1000.0}), module<Wire>()),
+      module<Biquad>(Value<biquad::Frequency>{2000.0}, Value<biquad::Q>{0.7}),
+      split(module<Delay>(Value<delay::Length>{5}),
+            module<Accumulator>(Value<accumulator::Wrap>{4})),
+      module<Crossfade>(Value<crossfade::Fade>{0.5}),
+      recursive(module<Gain, Expose<gain::Gain>>(), module<Gain>(Value<gain::Gain>{0.25})));
+
+    auto processor = chain.makeProcessor<double>(48e3);
+    processor.prepare(48e3, 16);
+    hana::at_c<0>(processor.exposedInputs())->setValue(0.75);
+
+    const auto run = [](auto& processor, int start, int numFrames) {
+      std::vector<double> buffer(numFrames);
+      for (auto i = 0; i < numFrames; i += 16) {
+        for (auto j = i; j < std::min(i + 16, numFrames); ++j) {
+          buffer[j] = 0.01 * ((start + j) % 17);
+        }
+        processor.process(buffer.data() + i, buffer.data() + i, std::min(16, numFrames - i));
+      }
+      return buffer;
+    };
+
+    run(processor, 0, 100);
+    const auto state = snapshot(processor);
+    CHECK(state.size() == snapshotSize(processor));
+    CHECK(saveSnapshotFile(processor, "chains-snapshot.bin"));
+    const auto expected = run(processor, 100, 64);
+
+    // Restoring into a new processor continues where the snapshot was taken, with the
+    // exposed input's value restored
+    auto restored = chain.makeProcessor<double>(48e3);
+    restored.prepare(48e3, 16);
+    REQUIRE(restoreSnapshot(restored, state));
+    CHECK(hana::at_c<0>(restored.exposedInputs())->value() == 0.75);
+    CHECK(run(restored, 100, 64) == expected);
+
+    auto mapped = chain.makeProcessor<double>(48e3);
+    mapped.prepare(48e3, 16);
+    REQUIRE(loadSnapshotFile(mapped, "chains-snapshot.bin"));
+    CHECK(run(mapped, 100, 64) == expected);
+    std::remove("chains-snapshot.bin");
+
+    // Snapshots only restore into processors with the same layout
+    auto other = serial(module<Delay>(), module<Wire>()).makeProcessor<double>(48e3);
+    other.prepare(48e3, 16);
+    CHECK_FALSE(restoreSnapshot(other, state));
+    CHECK_FALSE(restoreSnapshot(restored, state.data(), state.size() - 1));
+
+    // Runs of the same size with different types have different layouts
+    chains::detail::StateLayout floats;
+    floats(static_cast<float*>(nullptr), 4);
+    chains::detail::StateLayout ints;
+    ints(static_cast<std::int32_t*>(nullptr), 4);
+    CHECK(floats.size == ints.size);
+    CHECK(floats.hash != ints.hash);
+  }
+
+  SECTION("Preset switching")
+  {
+    const auto chain =
+      serial(module<Biquad, Expose<biquad::Frequency, biquad::Q>>("Filter"),
+             module<Gain, Expose<gain::Gain>>("Output"));
+    auto processor = chain.makeProcessor<double>(48e3);
+    processor.prepare(48e3, 32);
+
+    CHECK(parameterNames(chain)
+          == std::vector<std::string>{"Filter Frequency", "Filter Q", "Output Gain"});
+    auto a = ParameterSet::defaults(chain);
+    REQUIRE(a.size() == 3);
+    a[0] = 1000.0;
+    a[2] = 0.5;
+    auto b = a;
+    b[0] = 3000.0;
+    b[2] = 1.0;
+
+    PresetSwitcher switcher{processor};
+    auto frequency = hana::at_c<0>(processor.exposedInputs());
+    auto q = hana::at_c<1>(processor.exposedInputs());
+    auto frequencyCallbacks = 0;
+    auto qCallbacks = 0;
+    frequency->setCallback([&](double) { ++frequencyCallbacks; });
+    q->setCallback([&](double) { ++qCallbacks; });
+    frequencyCallbacks = qCallbacks = 0;
+
+    // A published set is only applied at the start of the next block
+    std::thread control{[&] { CHECK(switcher.publish(a)); }};
+    control.join();
+    CHECK_FALSE(switcher.publish(b));
+    CHECK(frequency->value() != 1000.0);
+
+    std::vector<double> buffer(32, 1.0);
+    switcher.process(processor, buffer.data(), buffer.data(), 32);
+    CHECK(switcher.current() == a);
+    CHECK(frequency->value() == 1000.0);
+    CHECK(hana::at_c<2>(processor.exposedInputs())->value() == 0.5);
+    CHECK(frequencyCallbacks == 1);
+    // Unchanged values don't trigger callbacks
+    CHECK(qCallbacks == 0);
+    CHECK_FALSE(switcher.applyPending());
+
+    // Morphing between sets interpolates each value
+    switcher.morph(a, b, 0.25);
+    CHECK(frequency->value() == Approx(1500.0));
+    CHECK(hana::at_c<2>(processor.exposedInputs())->value() == Approx(0.625));
+    CHECK(frequencyCallbacks == 2);
+
+    auto c = b;
+    c[1] = 2.0;
+    const ParameterSet* sets[] = {&a, &b, &c};
+    const double weights[] = {0.5, 0.25, 0.25};
+    switcher.morph(sets, weights, 3);
+    CHECK(frequency->value() == Approx(2000.0));
+    CHECK(q->value() == Approx(0.5 * a[1] + 0.25 * a[1] + 0.25 * 2.0));
+    CHECK(qCallbacks == 1);
+    switcher.morph(sets, weights, 3);
+    CHECK(frequencyCallbacks == 3);
+    CHECK(qCallbacks == 1);
+  }
+
+  SECTION("Precision")
+  {
+    using namespace accumulator;
+
+    // The accumulator drifts in float, but not when it's overridden to run in double
+    const auto accumulate =
+      module<Accumulator>(Value<Amount>(0.001), Value<Wrap>(1000.0));
+    const auto chain = serial(module<Gain>(Value<gain::Gain>{2.0}),
+                              precision<double>(accumulate),
+                              module<Gain>(Value<gain::Gain>{0.5}));
+    auto mixed = chain.makeProcessor<float>(48e3);
+    auto single = serial(module<Gain>(Value<gain::Gain>{2.0}), accumulate,
+                         module<Gain>(Value<gain::Gain>{0.5}))
+                    .makeProcessor<float>(48e3);
+    auto reference = chain.makeProcessor<double>(48e3);
+    static_assert(std::is_same<decltype(mixed.tick(0.0f)), float>::value, "");
+
+    const auto numFrames = 10000;
+    auto mixedError = 0.0;
+    auto singleError = 0.0;
+    for (auto i = 0; i < numFrames; ++i) {
+      const auto expected = reference.tick(1.0);
+      mixedError = std::max(mixedError, std::abs(double(mixed.tick(1.0f)) - expected));
+      singleError = std::max(singleError, std::abs(double(single.tick(1.0f)) - expected));
+    }
+    CAPTURE(mixedError, singleError);
+    CHECK(mixedError < 1e-5);
+    CHECK(singleError > 1e-4);
+
+    // Blocks are converted at the boundaries, and match per-sample processing
+    auto blockProcessor = chain.makeProcessor<float>(48e3);
+    auto tickProcessor = chain.makeProcessor<float>(48e3);
+    blockProcessor.prepare(48e3, 64);
+    std::vector<float> block(200);
+    std::iota(block.begin(), block.end(), 0.0f);
+    auto expected = block;
+    for (auto& sample : expected) {
+      sample = tickProcessor.tick(sample);
+    }
+    for (auto i = 0; i < 200; i += 64) {
+      blockProcessor.process(block.data() + i, block.data() + i, std::min(64, 200 - i));
+    }
+    CHECK(block == expected);
+  }
+
+  SECTION("Fixed point")
+  {
+    using dsp::Q15;
+    using dsp::Q31;
+
+    // Arithmetic saturates at the ends of the range
+    CHECK(double(Q15(0.75) + Q15(0.75)) == Approx(1.0).epsilon(1e-4));
+    CHECK(Q15(-1.0) * Q15(-1.0) == Q15(1));
+    CHECK(Q15(-0.5) - Q15(0.75) == Q15(-1));
+    CHECK(double(Q31(0.25) * Q31(-0.5)) == -0.125);
+    CHECK(double(Q15(0.3)) == Approx(0.3).margin(1.0 / (1 << 16)));
+
+    // Gains above 1 are applied without saturating the gain
+    auto gain = serial(module<Gain>(Value<gain::Gain>{2.0})).makeProcessor<Q15>(48e3);
+    CHECK(gain.tick(Q15(0.25)) == Q15(0.5));
+    CHECK(gain.tick(Q15(0.75)) == Q15(1));
+
+    // Exposed values are converted by their inputs' callbacks when they change
+    auto exposedGain =
+      serial(module<Gain, Expose<gain::Gain>>()).makeProcessor<Q15>(48e3);
+    CHECK(exposedGain.tick(Q15(0.25)) == Q15(0.25));
+    hana::at_c<0>(exposedGain.exposedInputs())->setValue(0.5);
+    CHECK(exposedGain.tick(Q15(0.25)) == Q15(0.125));
+    auto copy = exposedGain;
+    hana::at_c<0>(copy.exposedInputs())->setValue(2.0);
+    CHECK(copy.tick(Q15(0.25)) == Q15(0.5));
+    CHECK(exposedGain.tick(Q15(0.25)) == Q15(0.125));
+
+    auto accumulator =
+      serial(module<Accumulator>(Value<accumulator::Amount>{0.5},
+                                 Value<accumulator::Wrap>{0.75}))
+        .makeProcessor<Q31>(48e3);
+    CHECK(double(accumulator.tick(Q31(0.5))) == 0.25);
+    CHECK(double(accumulator.tick(Q31(0.5))) == 0.5);
+    CHECK(double(accumulator.tick(Q31(0.5))) == 0.0);
+
+    // Chains follow the double path to within the sample type's resolution
+    const auto chain =
+      serial(module<Gain>(Value<gain::Gain>{0.8}),
+             module<Biquad>(Value<biquad::Frequency>{2000.0}, Value<biquad::Q>{0.707}),
+             split(module<Gain>(Value<gain::Gain>{0.5}),
+                   module<Delay>(Value<delay::Length>{10})),
+             module<Crossfade>(Value<crossfade::Fade>{0.3}, Value<crossfade::Curve>{1.0}),
+             module<Gain>(Value<gain::Gain>{0.9}));
+
+    const auto numFrames = 4096;
+    std::vector<double> input(numFrames);
+    auto seed = 1u;
+    for (auto& sample : input) {
+      seed = seed * 1664525u + 1013904223u;
+      sample = double(seed >> 8) / double(1 << 24) - 0.5;
+    }
+
+    const auto maxError = [&](auto sampleType) {
+      using T = decltype(sampleType);
+      auto reference = chain.makeProcessor<double>(48e3);
+      auto processor = chain.makeProcessor<T>(48e3);
+      reference.prepare(48e3, 64);
+      processor.prepare(48e3, 64);
+
+      auto expected = input;
+      std::vector<T> buffer(numFrames);
+      std::transform(input.begin(), input.end(), buffer.begin(),
+                     [](double x) { return T(x); });
+      for (auto i = 0; i < numFrames; i += 64) {
+        reference.process(expected.data() + i, expected.data() + i, 64);
+        processor.process(buffer.data() + i, buffer.data() + i, 64);
+      }
+
+      auto error = 0.0;
+      for (auto i = 0; i < numFrames; ++i) {
+        error = std::max(error, std::abs(double(buffer[i]) - expected[i]));
+      }
+      return error;
+    };
+
+    const auto q31Error = maxError(Q31{});
+    const auto q15Error = maxError(Q15{});
+    CAPTURE(q31Error, q15Error);
+    CHECK(q31Error < 1e-7);
+    CHECK(q15Error < 1e-3);
+
+    auto phasor =
+      serial(module<Phasor>(Value<phasor::Frequency>{480.0})).makeProcessor<Q15>(48e3);
+    auto phasorReference =
+      serial(module<Phasor>(Value<phasor::Frequency>{480.0})).makeProcessor<double>(48e3);
+    for (auto i = 0; i < 1000; ++i) {
+      const auto expected = phasorReference.tick(0.0);
+      CHECK(double(phasor.tick(Q15(0))) == Approx(expected).margin(1e-4));
+    }
+  }
+
+  SECTION("Footprint")
+  {
+    const auto chain =
+      serial(module<Gain>().named("Input"),
+             parallel(module<Delay>().named("Echo"), module<Biquad>().named("Filter")),
+             precision<double>(module<Gain>()));
+    auto processor = chain.makeProcessor<float>(48e3);
+    processor.prepare(48e3, 64);
+
+    const auto report = footprintReport(processor);
+    REQUIRE(report.size() == 7);
+    const std::vector<std::pair<int, std::string>> nodes{
+      {0, "serial"}, {1, "Input"},     {1, "parallel"}, {2, "Echo"},
+      {2, "Filter"}, {1, "precision"}, {2, "chains::gain::Module"}};
+    for (auto i = 0; i < 7; ++i) {
+      CHECK(report[i].depth == nodes[i].first);
+      CHECK(report[i].name == nodes[i].second);
+    }
+
+    // The delay's buffer is on the heap, and the root's total includes its nodes
+    CHECK(report[3].footprint.heap == delay::bufferSize * sizeof(float));
+    const auto& root = report[0].footprint;
+    CHECK(root.hot + root.cold == sizeof(processor));
+    CHECK(root.heap >= report[2].footprint.heap + report[5].footprint.heap);
+    CHECK(report[2].footprint.hot
+          == report[3].footprint.hot + report[4].footprint.hot);
+
+    // Inputs with callbacks are only read when their values change, so the phasor's
+    // exposed frequency is cold, while the gain's constant is read while processing
+    auto phasor = module<Phasor, Expose<phasor::Frequency>>().makeProcessor<float>(48e3);
+    auto gain = module<Gain>().makeProcessor<float>(48e3);
+    phasor.init();
+    using PhasorProcessor = decltype(phasor);
+    using GainProcessor = decltype(gain);
+    static_assert(hotStateSize<PhasorProcessor>() < coldStateSize<PhasorProcessor>(), "");
+    static_assert(hotStateSize<GainProcessor>() == sizeof(double), "");
+    CHECK(footprint(phasor).heap == sizeof(ValueCallback));
+    CHECK(footprint(gain).heap == 0);
+  }
+
+  SECTION("Multi-tap delay")
+  {
+    using namespace multi_tap_delay;
+
+    std::vector<double> input(20000);
+    auto seed = 1u;
+    for (auto& sample : input) {
+      seed = seed * 1664525u + 1013904223u;
+      sample = double(seed >> 8) / double(1 << 24) - 0.5;
+    }
+    const auto at = [&input](int i) { return i < 0 ? 0.0 : input[i]; };
+
+    // The taps are summed, with fractional lengths interpolated between samples
+    const auto taps = module<MultiTapDelay<3>>(
+      Value<TapLength<0>>{3.0}, Value<TapLength<1>>{10.25}, Value<TapGain<1>>{0.5},
+      Value<TapLength<2>>{4095.5}, Value<TapGain<2>>{-0.25});
+    auto processor = serial(taps).makeProcessor<double>(48e3);
+    auto ticked = std::vector<double>(input.size());
+    for (auto i = 0; i < int(input.size()); ++i) {
+      ticked[i] = processor.tick(input[i]);
+      const auto expected = at(i - 3) + 0.5 * (0.75 * at(i - 10) + 0.25 * at(i - 11))
+                            - 0.25 * (0.5 * at(i - 4095) + 0.5 * at(i - 4096));
+      REQUIRE(ticked[i] == Approx(expected).margin(1e-12));
+    }
+
+    // Blocks match per-sample processing, including blocks longer than a chunk
+    for (const auto blockSize : {1, 64, 1000, 5000}) {
+      auto blockProcessor = serial(taps).makeProcessor<double>(48e3);
+      blockProcessor.prepare(48e3, blockSize);
+      auto output = input;
+      for (auto i = 0; i < int(output.size()); i += blockSize) {
+        const auto numFrames = std::min(blockSize, int(output.size()) - i);
+        blockProcessor.process(output.data() + i, output.data() + i, numFrames);
+      }
+      CAPTURE(blockSize);
+      for (auto i = 0; i < int(output.size()); ++i) {
+        REQUIRE(output[i] == Approx(ticked[i]).margin(1e-12));
+      }
+    }
+
+    // Tap parameters are exposed like any other parameters
+    const auto echo = module<MultiTapDelay<2>, Expose<TapLength<1>, TapGain<1>>>(
+      "Echo", Value<TapGain<0>>{0});
+    CHECK(hana::at_c<0>(echo.exposedParameters()).name() == "Echo Tap 2 Length");
+    CHECK(hana::at_c<1>(echo.exposedParameters()).name() == "Echo Tap 2 Gain");
+    auto echoProcessor = echo.makeProcessor<float>(48e3);
+    echoProcessor.init();
+    hana::at_c<0>(echoProcessor.exposedInputs())->setValue(2.0);
+    hana::at_c<1>(echoProcessor.exposedInputs())->setValue(0.5);
+    CHECK(echoProcessor.tailLength() == 3);
+    CHECK(echoProcessor.tick(1.0f) == 0.0f);
+    CHECK(echoProcessor.tick(0.0f) == 0.0f);
+    CHECK(echoProcessor.tick(0.0f) == 0.5f);
+
+    // Only the first tap is heard by default
+    auto fourTaps = module<MultiTapDelay<4>>().makeProcessor<float>(48e3);
+    CHECK(fourTaps.tick(1.0f) == 1.0f);
+    CHECK(fourTaps.tick(0.5f) == 0.5f);
+
+    // The taps share a single buffer
+    CHECK(footprint(fourTaps).heap < 4 * delay::bufferSize * sizeof(float));
+  }
+
   SECTION("Synth")
   {
     // const auto osc = serial(
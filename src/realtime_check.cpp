@@ -0,0 +1,181 @@
+#define CHAINS_REALTIME_CHECK_IMPLEMENTATION
+#include "chains/realtime_check.hpp"
+
+#include "chains/dsp/fixed_point.hpp"
+#include "chains/groups/multi_channel.hpp"
+#include "chains/groups/parallel.hpp"
+#include "chains/groups/precision.hpp"
+#include "chains/groups/recursive.hpp"
+#include "chains/groups/serial.hpp"
+#include "chains/groups/spectral.hpp"
+#include "chains/groups/split.hpp"
+#include "chains/modules/accumulator.hpp"
+#include "chains/modules/biquad.hpp"
+#include "chains/modules/convolver.hpp"
+#include "chains/modules/crossfade.hpp"
+#include "chains/modules/delay.hpp"
+#include "chains/modules/gain.hpp"
+#include "chains/modules/multi_tap_delay.hpp"
+#include "chains/modules/ones.hpp"
+#include "chains/modules/phasor.hpp"
+#include "chains/modules/probe.hpp"
+#include "chains/modules/wire.hpp"
+
+#include <catch/single_include/catch.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Runs the built-in modules and groups with real-time checks enabled, checking that
+// processing doesn't allocate or block. Built with CHAINS_REALTIME_CHECKS.
+
+using namespace chains;
+
+namespace {
+
+struct RecordedViolation
+{
+  std::string node;
+  std::string call;
+};
+
+std::vector<RecordedViolation> violations;
+
+void recordViolation(const realtime::Violation& violation)
+{
+  violations.push_back({violation.node, violation.call});
+}
+
+struct TestRoom : convolver::ImpulseResponse
+{
+  static int partitionSize() { return 32; }
+  static std::vector<double> samples() { return std::vector<double>(300, 0.01); }
+};
+
+// Ticks and processes a serial chain of the modules with sample type T, in blocks and
+// with silent input, returning the violations that were reported
+template <class T, class... Modules>
+std::vector<RecordedViolation> checkChain(const Modules&... modules)
+{
+  const auto blockSize = 64;
+  auto processor = serial(modules...).template makeProcessor<T>(48e3);
+  processor.prepare(48e3, blockSize);
+  std::vector<T> in(blockSize, T(0.5));
+  std::vector<T> out(blockSize);
+
+  violations.clear();
+  for (auto i = 0; i < 2 * blockSize; ++i) {
+    processor.tick(T(0.25));
+  }
+  for (auto block = 0; block < 20; ++block) {
+    processor.process(in.data(), out.data(), blockSize);
+  }
+  for (auto block = 0; block < 200; ++block) {
+    processor.process(in.data(), out.data(), blockSize, true);
+  }
+  return violations;
+}
+
+template <class T>
+void checkModules()
+{
+  using namespace accumulator;
+  CHECK(checkChain<T>(module<Accumulator>(Value<Amount>{0.01})).empty());
+  CHECK(checkChain<T>(module<Biquad>(Value<biquad::Q>{0.7})).empty());
+  CHECK(
+    checkChain<T>(split(module<Gain>(), module<Wire>()), module<Crossfade>()).empty());
+  CHECK(checkChain<T>(module<Delay>(Value<delay::Length>{10})).empty());
+  CHECK(checkChain<T>(module<Gain>(Value<gain::Gain>{0.5})).empty());
+  CHECK(checkChain<T>(module<MultiTapDelay<3>>(Value<multi_tap_delay::TapLength<1>>{2.5}))
+          .empty());
+  CHECK(checkChain<T>(module<Ones>()).empty());
+  CHECK(checkChain<T>(module<Phasor>()).empty());
+  CHECK(checkChain<T>(module<Wire>()).empty());
+}
+
+} // namespace
+
+TEST_CASE("Real-time checks")
+{
+  const auto previousHandler = realtime::setViolationHandler(&recordViolation);
+
+  SECTION("Violations are reported by node")
+  {
+    violations.clear();
+    {
+      const realtime::Section section{"Outer"};
+      {
+        const realtime::Section inner{"Inner"};
+        delete new int(1);
+      }
+      auto* allocation = std::malloc(4);
+      {
+        const realtime::Unchecked unchecked;
+        std::free(allocation);
+      }
+    }
+    delete new int(1);
+
+    REQUIRE(violations.size() == 3);
+    CHECK(violations[0].node == "Inner");
+    CHECK(violations[0].call == "operator new");
+    CHECK(violations[1].node == "Inner");
+    CHECK(violations[1].call == "operator delete");
+    CHECK(violations[2].node == "Outer");
+    CHECK(violations[2].call == "malloc");
+  }
+
+  SECTION("Modules")
+  {
+    checkModules<float>();
+    checkModules<double>();
+    checkModules<dsp::Q31>();
+    checkModules<dsp::Q15>();
+    CHECK(checkChain<float>(module<Convolver<TestRoom>>()).empty());
+    const auto ir = std::make_shared<const dsp::PartitionedImpulseResponse<float>>(
+      std::vector<double>(600, 0.01), 128, true);
+    CHECK(checkChain<float>(convolver::withImpulseResponse(ir)).empty());
+  }
+
+  SECTION("Groups")
+  {
+    CHECK(checkChain<float>(parallel(module<Gain>(), module<Delay>())).empty());
+    const auto feedback = module<Gain>(Value<gain::Gain>{0.5});
+    CHECK(checkChain<float>(recursive(module<Gain>(), feedback)).empty());
+    CHECK(checkChain<float>(spectral(64, 16, module<Gain>())).empty());
+    CHECK(checkChain<float>(precision<double>(module<Biquad>(Value<biquad::Q>{0.7})))
+            .empty());
+
+    auto stereo = multiChannel<2>(serial(module<Biquad>()).makeProcessor<float>(48e3));
+    stereo.prepare(48e3, 64);
+    std::vector<float> left(64, 0.5f);
+    std::vector<float> right(64, 0.5f);
+    const auto bus = Bus<float, 2>::planar({{left.data(), right.data()}}, 64);
+    std::vector<float> frames(128, 0.5f);
+    const auto interleaved = Bus<float, 2>::interleaved(frames.data(), 64);
+    violations.clear();
+    stereo.process(bus);
+    stereo.process(interleaved);
+    CHECK(violations.empty());
+  }
+
+  SECTION("Probe")
+  {
+    // Probes write to std::cout, which is reported against the probe's name
+    auto processor = serial(module<Probe>("Probe")).makeProcessor<float>(48e3);
+    violations.clear();
+    processor.tick(0.5f);
+    REQUIRE(!violations.empty());
+    CHECK(violations[0].node == "Probe");
+
+    // Unnamed modules are reported by their type's name
+    auto unnamed = serial(module<Probe>()).makeProcessor<float>(48e3);
+    violations.clear();
+    unnamed.tick(0.5f);
+    REQUIRE(!violations.empty());
+    CHECK(violations[0].node == std::string{"chains::probe::Module"});
+  }
+
+  realtime::setViolationHandler(previousHandler);
+}
@@ -0,0 +1,114 @@
+#include "chains/groups/serial.hpp"
+#include "chains/module.hpp"
+#include "chains/modules/biquad.hpp"
+#include "chains/modules/gain.hpp"
+#include "chains/render.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Renders an audio file through a chain, and reports the render's throughput.
+//
+// Usage: render [options] input output.wav
+//   --raw <int16|int24|int32|float32|float64> <channels> <sample rate>
+//       Reads the input as headerless interleaved samples
+//   --block <frames>
+//       The block size used for processing, 1024 by default
+
+namespace {
+
+bool parseSampleFormat(const char* name, chains::io::SampleFormat& format)
+{
+  using chains::io::SampleFormat;
+
+  const struct
+  {
+    const char* name;
+    SampleFormat format;
+  } formats[] = {{"int16", SampleFormat::Int16},
+                 {"int24", SampleFormat::Int24},
+                 {"int32", SampleFormat::Int32},
+                 {"float32", SampleFormat::Float32},
+                 {"float64", SampleFormat::Float64}};
+
+  for (const auto& entry : formats) {
+    if (std::strcmp(name, entry.name) == 0) {
+      format = entry.format;
+      return true;
+    }
+  }
+  return false;
+}
+
+int usage()
+{
+  std::fprintf(stderr,
+               "Usage: render [--raw <format> <channels> <sample rate>] [--block <frames>] "
+               "input output.wav\n");
+  return EXIT_FAILURE;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  using namespace chains;
+
+  auto raw = false;
+  io::AudioFormat rawFormat;
+  auto blockSize = 1024;
+
+  auto arg = 1;
+  for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+    if (std::strcmp(argv[arg], "--raw") == 0 && arg + 3 < argc) {
+      if (!parseSampleFormat(argv[arg + 1], rawFormat.sampleFormat)) {
+        return usage();
+      }
+      rawFormat.numChannels = std::atoi(argv[arg + 2]);
+      rawFormat.sampleRate = std::atof(argv[arg + 3]);
+      raw = true;
+      arg += 3;
+    } else if (std::strcmp(argv[arg], "--block") == 0 && arg + 1 < argc) {
+      blockSize = std::atoi(argv[++arg]);
+    } else {
+      return usage();
+    }
+  }
+
+  if (argc - arg != 2 || blockSize <= 0 || (raw && rawFormat.numChannels <= 0)) {
+    return usage();
+  }
+
+  io::AudioFileReader input;
+  if (!(raw ? input.openRaw(argv[arg], rawFormat) : input.openWav(argv[arg]))) {
+    std::fprintf(stderr, "%s\n", input.error().c_str());
+    return EXIT_FAILURE;
+  }
+
+  const auto& format = input.format();
+
+  io::WavFileWriter output;
+  if (!output.open(argv[arg + 1], format.numChannels, format.sampleRate)) {
+    std::fprintf(stderr, "Unable to create %s\n", argv[arg + 1]);
+    return EXIT_FAILURE;
+  }
+
+  const auto chain = serial(module<Biquad>(Value<biquad::Frequency>(5000.0)),
+                            module<Gain>(Value<gain::Gain>(0.8)));
+  const auto processor = chain.makeProcessor<float>(format.sampleRate);
+
+  const auto stats = render<float>(processor, input, output, blockSize);
+
+  if (!output.close()) {
+    std::fprintf(stderr, "Unable to write %s\n", argv[arg + 1]);
+    return EXIT_FAILURE;
+  }
+
+  std::printf("%lld frames, %d channels: %.3f s, %.1f Msamples/s, %.1fx realtime\n",
+              static_cast<long long>(stats.numFrames), stats.numChannels, stats.seconds,
+              stats.samplesPerSecond() * 1e-6, stats.realtimeFactor());
+
+  return EXIT_SUCCESS;
+}